@@ -14,7 +14,7 @@ def run_cpp_interactively(executable_path):
         while True:
             line = process.stdout.readline()
             print(line, end='')
-            if line.strip() == "> Run test (1 ~ 5) or exit (0):":
+            if line.strip() == "> Run test (1 ~ 21) or exit (0):":
                 break
 
         # Provide additional input
@@ -26,7 +26,7 @@ def run_cpp_interactively(executable_path):
         while True:
             line = process.stdout.readline()
             print(line, end='')
-            if line.strip() == "> Run test (1 ~ 5) or exit (0):":
+            if line.strip() == "> Run test (1 ~ 21) or exit (0):":
                 break
 
         # Check if the process ran successfully
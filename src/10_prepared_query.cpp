@@ -0,0 +1,158 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_prepared_query()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 32;
+    const double TOLERANCE = 1e-4;
+    const size_t REPS = 5;
+
+    print_example_banner("Test: Prepared Query");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Dimension of vectors: " << DIMENSION << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+
+    /* Encoding and encrypting matrix */
+    Plaintext plain_vector;
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        encoder.encode(matrix[i], scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        encrypted_matrix[i] = encrypted_vector;
+    }
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /* Encoding and encrypting vector */
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+    vector<double> true_results = packed_matrix_vec_product(matrix, duplicated_vec, DIMENSION);
+
+    chrono::high_resolution_clock::time_point time_start, time_end;
+    auto check_results = [&](vector<Ciphertext> &product_vector) {
+        vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+        for (size_t i = 0; i < true_results.size(); i++)
+        {
+            if (abs(true_results[i] - results[i]) >= TOLERANCE)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    /* Timing the current product */
+    print_line(__LINE__);
+    vector<Ciphertext> product_vector;
+    time_start = chrono::high_resolution_clock::now();
+    for (size_t rep = 0; rep < REPS; rep++)
+    {
+        product_vector = CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, encrypted_vector, DIMENSION);
+    }
+    time_end = chrono::high_resolution_clock::now();
+    auto before_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+    cout << "Per-row time before: " << before_time.count() / (REPS * NUM_ROWS) << " microseconds" << endl;
+    cout << "All deviations are within the tolerance: " << boolalpha << check_results(product_vector) << endl;
+
+    /* Timing the product with a prepared encrypted query */
+    print_line(__LINE__);
+    time_start = chrono::high_resolution_clock::now();
+    PreparedQuery query = prepare_query(context, evaluator, encrypted_vector, encrypted_matrix[0].parms_id());
+    time_end = chrono::high_resolution_clock::now();
+    cout << "Time to prepare the encrypted query: "
+         << chrono::duration_cast<chrono::microseconds>(time_end - time_start).count() << " microseconds" << endl;
+
+    time_start = chrono::high_resolution_clock::now();
+    for (size_t rep = 0; rep < REPS; rep++)
+    {
+        product_vector = CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, query, DIMENSION);
+    }
+    time_end = chrono::high_resolution_clock::now();
+    auto prepared_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+    cout << "Per-row time after: " << prepared_time.count() / (REPS * NUM_ROWS) << " microseconds" << endl;
+    cout << "All deviations are within the tolerance: " << check_results(product_vector) << endl;
+
+    /* Timing the product with a prepared plaintext query */
+    print_line(__LINE__);
+    time_start = chrono::high_resolution_clock::now();
+    PreparedQuery plain_query = prepare_plain_query(encoder, duplicated_vec, scale, encrypted_matrix[0].parms_id());
+    time_end = chrono::high_resolution_clock::now();
+    cout << "Time to prepare the plaintext query: "
+         << chrono::duration_cast<chrono::microseconds>(time_end - time_start).count() << " microseconds" << endl;
+
+    time_start = chrono::high_resolution_clock::now();
+    for (size_t rep = 0; rep < REPS; rep++)
+    {
+        product_vector = CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, plain_query, DIMENSION);
+    }
+    time_end = chrono::high_resolution_clock::now();
+    auto plain_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+    cout << "Per-row time in plaintext mode: " << plain_time.count() / (REPS * NUM_ROWS) << " microseconds" << endl;
+    cout << "All deviations are within the tolerance: " << check_results(product_vector) << endl << endl;
+}
@@ -0,0 +1,122 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_parallel_ingest()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 256;
+    const double TOLERANCE = 1e-4;
+    const size_t MAX_THREADS = max<size_t>(1, thread::hardware_concurrency());
+
+    print_example_banner("Test: Parallel Database Ingest");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    Encryptor encryptor(context, public_key);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+    cout << "Total number of unpacked vectors: " << num_vecs_per_row * NUM_ROWS << endl;
+    cout << "Maximum number of threads: " << MAX_THREADS << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+
+    /* Timing the serial loop the tests used before */
+    print_line(__LINE__);
+    chrono::high_resolution_clock::time_point time_start, time_end;
+    Plaintext plain_vector;
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    time_start = chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        encoder.encode(matrix[i], scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        encrypted_matrix[i] = encrypted_vector;
+    }
+    time_end = chrono::high_resolution_clock::now();
+    auto serial_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+    cout << "Serial loop: " << NUM_ROWS * 1e6 / serial_time.count() << " rows per second" << endl;
+
+    /* Timing the bulk ingest for each thread count */
+    vector<size_t> thread_counts;
+    for (size_t num_threads = 1; num_threads < MAX_THREADS; num_threads *= 2)
+    {
+        thread_counts.push_back(num_threads);
+    }
+    thread_counts.push_back(MAX_THREADS);
+
+    vector<double> rows_per_second;
+    for (size_t num_threads : thread_counts)
+    {
+        encrypted_matrix.assign(NUM_ROWS, Ciphertext());
+        time_start = chrono::high_resolution_clock::now();
+        CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix, num_threads);
+        time_end = chrono::high_resolution_clock::now();
+        auto time_diff = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+        rows_per_second.push_back(NUM_ROWS * 1e6 / time_diff.count());
+
+        /* Checking the last row, which is written by the last thread */
+        vector<double> decoded;
+        decryptor.decrypt(encrypted_matrix.back(), plain_vector);
+        encoder.decode(plain_vector, decoded);
+        bool all_within_tol = true;
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            if (abs(decoded[j] - matrix.back()[j]) >= TOLERANCE)
+            {
+                all_within_tol = false;
+            }
+        }
+
+        cout << "Threads: " << num_threads << ", rows per second: " << rows_per_second.back()
+             << ", embeddings per second: " << rows_per_second.back() * num_vecs_per_row
+             << ", speedup over serial loop: " << static_cast<double>(serial_time.count()) / time_diff.count()
+             << ", within tolerance: " << boolalpha << all_within_tol << endl;
+    }
+
+    cout << endl << "All rows per second, by thread count: " << endl;
+    print_vector(rows_per_second, rows_per_second.size(), 1);
+    cout << endl;
+}
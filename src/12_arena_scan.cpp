@@ -0,0 +1,177 @@
+#include "native/examples/examples.h"
+#include "arena_pool.h"
+#include "my_utils.h"
+#include "perf_counters.h"
+
+using namespace std;
+using namespace seal;
+
+void test_arena_scan()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 128;
+    const double TOLERANCE = 1e-4;
+    const size_t REPS = 3;
+    const size_t SCRATCH_BYTES_PER_THREAD = size_t(64) << 20;
+    const size_t MAX_THREADS = max<size_t>(1, thread::hardware_concurrency());
+
+    print_example_banner("Test: Huge Page Arena Scan");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+
+    /* Encrypting the rows into the global pool */
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+
+    /* Encrypting the same rows into one arena sized for all of them */
+    size_t coeff_modulus_size = context.first_context_data()->parms().coeff_modulus().size();
+    size_t ciphertext_bytes = 2 * poly_modulus_degree * coeff_modulus_size * sizeof(uint64_t);
+    auto database_arena = make_shared<ArenaMemoryPool>(NUM_ROWS * ciphertext_bytes + ciphertext_bytes);
+    MemoryPoolHandle database_pool(database_arena);
+    vector<Ciphertext> arena_matrix;
+    arena_matrix.reserve(NUM_ROWS);
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        arena_matrix.emplace_back(database_pool);
+    }
+    CKKS_encrypt_rows(context, public_key, scale, matrix, arena_matrix);
+    cout << "Database arena: " << (database_arena->capacity_bytes() >> 20) << " MB backed by "
+         << arena_backing_name(database_arena->backing()) << ", "
+         << (database_arena->overflow_byte_count() >> 20) << " MB overflowed to the heap" << endl;
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /* Encoding and encrypting vector */
+    Plaintext plain_vector;
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+    PreparedQuery query = prepare_query(context, evaluator, encrypted_vector, encrypted_matrix[0].parms_id());
+    vector<double> true_results = packed_matrix_vec_product(matrix, duplicated_vec, DIMENSION);
+
+    PerfCounters counters({ perf_counter_type::dtlb_misses, perf_counter_type::llc_misses });
+    if (!counters.any_available())
+    {
+        cout << "Hardware counters are not permitted, only throughput is reported." << endl;
+    }
+
+    vector<size_t> thread_counts = { 1 };
+    if (MAX_THREADS > 1)
+    {
+        thread_counts.push_back(MAX_THREADS);
+    }
+
+    for (size_t num_threads : thread_counts)
+    {
+        /* Per-thread scratch arenas, created once and reused by every scan */
+        vector<MemoryPoolHandle> scratch_pools;
+        for (size_t t = 0; t < num_threads; t++)
+        {
+            scratch_pools.emplace_back(make_shared<ArenaMemoryPool>(SCRATCH_BYTES_PER_THREAD));
+        }
+
+        for (bool use_arena : { false, true })
+        {
+            vector<Ciphertext> &rows = use_arena ? arena_matrix : encrypted_matrix;
+            vector<MemoryPoolHandle> pools = use_arena ? scratch_pools : vector<MemoryPoolHandle>();
+
+            /* Warm up the pools so that the scan reuses their allocations */
+            vector<Ciphertext> product_vector =
+                parallel_CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, rows, query, DIMENSION, num_threads, pools);
+
+            counters.start();
+            auto time_start = chrono::high_resolution_clock::now();
+            for (size_t rep = 0; rep < REPS; rep++)
+            {
+                product_vector =
+                    parallel_CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, rows, query, DIMENSION, num_threads, pools);
+            }
+            auto time_end = chrono::high_resolution_clock::now();
+            counters.stop();
+            vector<uint64_t> counts = counters.read();
+            auto time_diff = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+
+            vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+            bool all_within_tol = true;
+            for (size_t i = 0; i < true_results.size(); i++)
+            {
+                if (abs(true_results[i] - results[i]) >= TOLERANCE)
+                {
+                    all_within_tol = false;
+                }
+            }
+
+            print_line(__LINE__);
+            cout << (use_arena ? "Arena pools" : "Global pool") << " with " << num_threads << " threads" << endl;
+            cout << "Scan throughput: " << REPS * NUM_ROWS * 1e6 / time_diff.count() << " rows per second" << endl;
+            for (size_t e = 0; e < counts.size(); e++)
+            {
+                if (counters.available(e))
+                {
+                    cout << perf_counter_name(counters.events()[e]) << " per row: " << counts[e] / (REPS * NUM_ROWS) << endl;
+                }
+            }
+            cout << "All deviations are within the tolerance: " << boolalpha << all_within_tol << endl;
+        }
+    }
+    cout << endl;
+}
@@ -0,0 +1,158 @@
+#include "native/examples/examples.h"
+#include "encrypted_index.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_filtered_search()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 32;
+    const uint32_t NUM_TENANTS = 8;
+    const uint32_t NUM_LANGUAGES = 4;
+    const uint32_t NUM_DAYS = 365;
+    const double TOLERANCE = 1e-4;
+    const size_t REPS = 3;
+
+    print_example_banner("Test: Attribute-Filtered Search");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    size_t num_vecs = NUM_ROWS * num_vecs_per_row;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Dimension of vectors: " << DIMENSION << endl;
+    cout << "Number of rows: " << NUM_ROWS << " (" << num_vecs << " vectors)" << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    uniform_int_distribution<uint32_t> random_language(0, NUM_LANGUAGES - 1);
+    uniform_int_distribution<uint32_t> random_day(0, NUM_DAYS - 1);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /*
+    Filling the index tenant by tenant, as a bulk load would, so that each
+    tenant occupies a few rows; languages and dates are spread across all rows.
+    */
+    EncryptedIndex index(context, public_key, scale, DIMENSION);
+    vector<vector<double>> embeddings(num_vecs);
+    vector<BlockAttributes> attributes(num_vecs);
+    for (size_t i = 0; i < num_vecs; i++)
+    {
+        vector<double> embedding(DIMENSION);
+        for (size_t j = 0; j < DIMENSION; j++)
+        {
+            embedding[j] = unif(gen);
+        }
+        BlockAttributes block_attributes;
+        block_attributes.tenant = static_cast<uint32_t>(i * NUM_TENANTS / num_vecs);
+        block_attributes.language = random_language(gen);
+        block_attributes.date = random_day(gen);
+        size_t block_id = index.insert(embedding, block_attributes);
+        embeddings[block_id] = embedding;
+        attributes[block_id] = block_attributes;
+    }
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /* Encoding and encrypting vector */
+    Plaintext plain_vector;
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+
+    vector<pair<string, function<bool(const BlockAttributes &)>>> filters = {
+        { "No filter", [](const BlockAttributes &) { return true; } },
+        { "Half of the tenants", [&](const BlockAttributes &a) { return a.tenant < NUM_TENANTS / 2; } },
+        { "One tenant", [](const BlockAttributes &a) { return a.tenant == 3; } },
+        { "One tenant and language", [](const BlockAttributes &a) { return a.tenant == 3 && a.language == 0; } },
+        { "Last 30 days", [&](const BlockAttributes &a) { return a.date >= NUM_DAYS - 30; } }
+    };
+
+    for (auto &filter : filters)
+    {
+        print_line(__LINE__);
+        size_t num_matches = 0;
+        for (size_t block_id = 0; block_id < num_vecs; block_id++)
+        {
+            num_matches += filter.second(attributes[block_id]);
+        }
+
+        vector<size_t> row_ids;
+        vector<Ciphertext> product_vector;
+        auto time_start = chrono::high_resolution_clock::now();
+        for (size_t rep = 0; rep < REPS; rep++)
+        {
+            product_vector = index.filtered_matrix_vector_product(
+                evaluator, relin_keys, galois_keys, encrypted_vector, filter.second, row_ids
+            );
+        }
+        auto time_end = chrono::high_resolution_clock::now();
+        auto time_diff = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+
+        /* Matching blocks must hold their dot product, and every other block of an evaluated row zero */
+        vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+        bool all_within_tol = true;
+        for (size_t k = 0; k < row_ids.size(); k++)
+        {
+            for (size_t j = 0; j < num_vecs_per_row; j++)
+            {
+                size_t block_id = row_ids[k] * num_vecs_per_row + j;
+                double true_result = filter.second(attributes[block_id])
+                    ? vec_float_dot_product(embeddings[block_id], duplicated_vec, DIMENSION) : 0;
+                if (abs(true_result - results[k * num_vecs_per_row + j]) >= TOLERANCE)
+                {
+                    all_within_tol = false;
+                }
+            }
+        }
+
+        cout << filter.first << ": selectivity " << 100.0 * num_matches / num_vecs << "%, " << row_ids.size() << " of "
+             << NUM_ROWS << " rows evaluated" << endl;
+        cout << "Average query latency: " << time_diff.count() / REPS << " microseconds" << endl;
+        cout << "All deviations are within the tolerance: " << boolalpha << all_within_tol << endl;
+    }
+    cout << endl;
+}
@@ -0,0 +1,246 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_cascaded_search()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const size_t REDUCED_DIMENSION = 16;
+    const size_t LATENT_DIMENSION = 12;
+    const double NOISE = 0.02;
+    const size_t NUM_ROWS = 128;
+    const size_t K = 10;
+    const size_t NUM_CANDIDATES = 40;
+    const size_t NUM_QUERIES = 4;
+    const double TOLERANCE = 1e-4;
+
+    print_example_banner("Test: Cascaded Search");
+
+    /* Setting parameters for the rerank, as in the other tests */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+    double scale = pow(2.0, 40);
+
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting smaller parameters for the coarse pass, which only has to rank */
+    EncryptionParameters coarse_parms(scheme_type::ckks);
+
+    size_t coarse_poly_modulus_degree = 4096;
+    coarse_parms.set_poly_modulus_degree(coarse_poly_modulus_degree);
+    coarse_parms.set_coeff_modulus(CoeffModulus::Create(coarse_poly_modulus_degree, { 40, 20, 40 }));
+    double coarse_scale = pow(2.0, 20);
+
+    SEALContext coarse_context(coarse_parms);
+    print_parameters(coarse_context);
+    cout << endl;
+
+    /* Setting up keys and object instances for both parameter sets */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+    CKKSEncoder encoder(context);
+
+    KeyGenerator coarse_keygen(coarse_context);
+    SecretKey coarse_secret_key = coarse_keygen.secret_key();
+    PublicKey coarse_public_key;
+    coarse_keygen.create_public_key(coarse_public_key);
+    RelinKeys coarse_relin_keys;
+    coarse_keygen.create_relin_keys(coarse_relin_keys);
+    GaloisKeys coarse_galois_keys;
+    coarse_keygen.create_galois_keys(coarse_galois_keys);
+    Encryptor coarse_encryptor(coarse_context, coarse_public_key);
+    Evaluator coarse_evaluator(coarse_context);
+    Decryptor coarse_decryptor(coarse_context, coarse_secret_key);
+    CKKSEncoder coarse_encoder(coarse_context);
+
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    size_t num_vecs = NUM_ROWS * num_vecs_per_row;
+    size_t coarse_slot_count = coarse_encoder.slot_count();
+    size_t coarse_vecs_per_row = coarse_slot_count / REDUCED_DIMENSION;
+    size_t num_coarse_rows = (num_vecs + coarse_vecs_per_row - 1) / coarse_vecs_per_row;
+    cout << "Number of vectors: " << num_vecs << endl;
+    cout << "Full rows: " << NUM_ROWS << " of dimension " << DIMENSION << ", coarse rows: " << num_coarse_rows
+         << " of dimension " << REDUCED_DIMENSION << endl;
+    cout << "k: " << K << ", candidates reranked: " << NUM_CANDIDATES << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(0, 1);
+    normal_distribution<double> noise(0, NOISE);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Embeddings with a low-rank structure, as real ones have, so that PCA keeps most of the ranking */
+    vector<vector<double>> mixing(LATENT_DIMENSION, vector<double>(DIMENSION));
+    for (auto &latent_row : mixing)
+    {
+        for (double &value : latent_row)
+        {
+            value = unif(gen) / LATENT_DIMENSION;
+        }
+    }
+    auto random_embedding = [&]() {
+        vector<double> embedding(DIMENSION, 0);
+        for (size_t l = 0; l < LATENT_DIMENSION; l++)
+        {
+            double latent = unif(gen);
+            for (size_t i = 0; i < DIMENSION; i++)
+            {
+                embedding[i] += latent * mixing[l][i];
+            }
+        }
+        for (size_t i = 0; i < DIMENSION; i++)
+        {
+            embedding[i] += noise(gen);
+        }
+        return embedding;
+    };
+
+    vector<vector<double>> embeddings(num_vecs);
+    for (size_t v = 0; v < num_vecs; v++)
+    {
+        embeddings[v] = random_embedding();
+    }
+    PCAProjection projection = fit_pca(embeddings, REDUCED_DIMENSION);
+
+    /* Packing both layouts so that vector v is block v % vecs_per_row of row v / vecs_per_row */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    vector<vector<double>> coarse_matrix(num_coarse_rows, vector<double>(coarse_slot_count, 0ULL));
+    for (size_t v = 0; v < num_vecs; v++)
+    {
+        copy(embeddings[v].begin(), embeddings[v].end(), matrix[v / num_vecs_per_row].begin() + (v % num_vecs_per_row) * DIMENSION);
+        vector<double> reduced = pca_project(projection, embeddings[v]);
+        copy(reduced.begin(), reduced.end(),
+             coarse_matrix[v / coarse_vecs_per_row].begin() + (v % coarse_vecs_per_row) * REDUCED_DIMENSION);
+    }
+
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+    vector<Ciphertext> coarse_encrypted_matrix(num_coarse_rows);
+    CKKS_encrypt_rows(coarse_context, coarse_public_key, coarse_scale, coarse_matrix, coarse_encrypted_matrix);
+
+    auto duplicate = [](const vector<double> &vec, size_t count) {
+        vector<double> duplicated_vec(count, 0ULL);
+        for (size_t j = 0; j < count; j++)
+        {
+            duplicated_vec[j] = vec[j % vec.size()];
+        }
+        return duplicated_vec;
+    };
+    auto recall = [&](const vector<size_t> &found, const vector<size_t> &truth) {
+        size_t hits = 0;
+        for (size_t v : found)
+        {
+            hits += find(truth.begin(), truth.end(), v) != truth.end();
+        }
+        return static_cast<double>(hits) / truth.size();
+    };
+
+    chrono::high_resolution_clock::time_point time_start, time_mid, time_end;
+    double single_recall = 0, cascade_recall = 0;
+    int64_t single_time = 0, coarse_time = 0, rerank_time = 0;
+    size_t rerank_rows = 0;
+    bool all_within_tol = true;
+    DotProductEngine<CKKSScheme> rerank_engine(context, evaluator, relin_keys, galois_keys, DIMENSION);
+    for (size_t q = 0; q < NUM_QUERIES; q++)
+    {
+        vector<double> query = random_embedding();
+        vector<double> true_scores(num_vecs);
+        for (size_t v = 0; v < num_vecs; v++)
+        {
+            true_scores[v] = vec_float_dot_product(embeddings[v], query, DIMENSION);
+        }
+        vector<size_t> true_top_k = top_k_indices(true_scores, K);
+
+        /* Single-stage search over every full row */
+        Plaintext plain_vector;
+        Ciphertext encrypted_vector;
+        time_start = chrono::high_resolution_clock::now();
+        encoder.encode(duplicate(query, slot_count), scale, plain_vector);
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        vector<Ciphertext> product_vector =
+            CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, encrypted_vector, DIMENSION);
+        vector<double> scores = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+        vector<size_t> single_top_k = top_k_indices(scores, K);
+        time_end = chrono::high_resolution_clock::now();
+        single_time += chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        single_recall += recall(single_top_k, true_top_k);
+
+        /* Coarse pass over every coarse row, with the query projected but not centered */
+        time_start = chrono::high_resolution_clock::now();
+        Plaintext coarse_plain_vector;
+        Ciphertext coarse_encrypted_vector;
+        coarse_encoder.encode(duplicate(pca_project(projection, query, false), coarse_slot_count), coarse_scale, coarse_plain_vector);
+        coarse_encryptor.encrypt(coarse_plain_vector, coarse_encrypted_vector);
+        vector<Ciphertext> coarse_product_vector = CKKS_matrix_vector_product(
+            coarse_evaluator, coarse_relin_keys, coarse_galois_keys, coarse_encrypted_matrix, coarse_encrypted_vector, REDUCED_DIMENSION
+        );
+        vector<double> coarse_scores =
+            packed_CKKS_results(coarse_decryptor, coarse_encoder, coarse_product_vector, REDUCED_DIMENSION, coarse_vecs_per_row);
+        coarse_scores.resize(num_vecs);   // Drop the empty blocks of the last coarse row
+        vector<size_t> candidates = top_k_indices(coarse_scores, NUM_CANDIDATES);
+        time_mid = chrono::high_resolution_clock::now();
+
+        /* Rerank over only the full rows that hold a candidate */
+        vector<size_t> candidate_rows;
+        for (size_t v : candidates)
+        {
+            candidate_rows.push_back(v / num_vecs_per_row);
+        }
+        sort(candidate_rows.begin(), candidate_rows.end());
+        candidate_rows.erase(unique(candidate_rows.begin(), candidate_rows.end()), candidate_rows.end());
+
+        encoder.encode(duplicate(query, slot_count), scale, plain_vector);
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        vector<Ciphertext> rerank_product_vector;
+        for (size_t row : candidate_rows)
+        {
+            rerank_product_vector.push_back(rerank_engine.dot_product(encrypted_matrix[row], encrypted_vector));
+        }
+        vector<double> rerank_results = packed_CKKS_results(decryptor, encoder, rerank_product_vector, DIMENSION, num_vecs_per_row);
+        vector<double> rerank_scores(num_vecs, -numeric_limits<double>::infinity());
+        for (size_t v : candidates)
+        {
+            size_t k = lower_bound(candidate_rows.begin(), candidate_rows.end(), v / num_vecs_per_row) - candidate_rows.begin();
+            rerank_scores[v] = rerank_results[k * num_vecs_per_row + v % num_vecs_per_row];
+            if (abs(rerank_scores[v] - true_scores[v]) >= TOLERANCE)
+            {
+                all_within_tol = false;
+            }
+        }
+        vector<size_t> cascade_top_k = top_k_indices(rerank_scores, K);
+        time_end = chrono::high_resolution_clock::now();
+        coarse_time += chrono::duration_cast<chrono::microseconds>(time_mid - time_start).count();
+        rerank_time += chrono::duration_cast<chrono::microseconds>(time_end - time_mid).count();
+        rerank_rows += candidate_rows.size();
+        cascade_recall += recall(cascade_top_k, true_top_k);
+    }
+
+    print_line(__LINE__);
+    cout << "Single-stage search: recall@" << K << " " << single_recall / NUM_QUERIES << ", average latency "
+         << single_time / NUM_QUERIES << " microseconds" << endl;
+    cout << "Cascaded search: recall@" << K << " " << cascade_recall / NUM_QUERIES << ", average latency "
+         << (coarse_time + rerank_time) / NUM_QUERIES << " microseconds (coarse pass " << coarse_time / NUM_QUERIES
+         << ", rerank " << rerank_time / NUM_QUERIES << ")" << endl;
+    cout << "Average rows reranked: " << static_cast<double>(rerank_rows) / NUM_QUERIES << " of " << NUM_ROWS << endl;
+    cout << "Speedup: " << static_cast<double>(single_time) / (coarse_time + rerank_time) << endl;
+    cout << "The tolerance is: " << TOLERANCE << endl;
+    cout << "All reranked scores are within the tolerance: " << boolalpha << all_within_tol << endl << endl;
+}
@@ -0,0 +1,186 @@
+#include "native/examples/examples.h"
+#include "index_file.h"
+#include "my_utils.h"
+#include <unistd.h>
+
+using namespace std;
+using namespace seal;
+
+void test_prefetched_scan()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 256;   // Raise to make the index larger than RAM
+    const size_t CHUNK_ROWS = 64;  // Rows held in memory while writing and scanning
+    const double TOLERANCE = 1e-4;
+    const string INDEX_PATH = "prefetched_scan_index.bin";
+    const vector<pair<size_t, size_t>> READER_CONFIGS = { { 0, 0 }, { 4, 1 }, { 16, 2 } };   // Ring size, reader threads
+
+    print_example_banner("Test: Prefetched Scan From Disk");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /*
+    Creating, encrypting and writing the rows a chunk at a time, so that only
+    CHUNK_ROWS rows and the plaintext results are ever held in memory
+    */
+    vector<double> true_results;
+    {
+        IndexFileWriter writer(INDEX_PATH);
+        for (size_t first_row = 0; first_row < NUM_ROWS; first_row += CHUNK_ROWS)
+        {
+            size_t num_chunk_rows = min(CHUNK_ROWS, NUM_ROWS - first_row);
+            vector<vector<double>> matrix(num_chunk_rows, vector<double>(slot_count, 0ULL));
+            for (size_t i = 0; i < num_chunk_rows; i++)
+            {
+                for (size_t j = 0; j < slot_count; j++)
+                {
+                    matrix[i][j] = unif(gen);
+                }
+            }
+            vector<double> chunk_results = packed_matrix_vec_product(matrix, duplicated_vec, DIMENSION);
+            true_results.insert(true_results.end(), chunk_results.begin(), chunk_results.end());
+
+            vector<Ciphertext> encrypted_matrix(num_chunk_rows);
+            CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+            writer.append(encrypted_matrix);
+        }
+        writer.close();
+    }
+
+    /* Encoding and encrypting vector, prepared at the level of the rows */
+    Plaintext plain_vector;
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+    PreparedQuery query = prepare_query(context, evaluator, encrypted_vector, context.first_parms_id());
+    DotProductEngine<CKKSScheme> engine(context, evaluator, relin_keys, galois_keys, DIMENSION);
+
+    double ram_bytes = static_cast<double>(sysconf(_SC_PHYS_PAGES)) * sysconf(_SC_PAGESIZE);
+    for (auto &config : READER_CONFIGS)
+    {
+        print_line(__LINE__);
+        PrefetchingReader reader(context, INDEX_PATH, config.first, config.second);
+        double index_bytes = static_cast<double>(reader.num_rows()) * reader.record_bytes();
+        if (config.first == 0)
+        {
+            cout << "Synchronous reads";
+        }
+        else
+        {
+            cout << "Ring of " << config.first << " buffers, " << config.second << " reader threads";
+        }
+        cout << (reader.direct_io() ? ", O_DIRECT" : ", page cache (O_DIRECT is not supported here)") << endl;
+        cout << "Index size: " << index_bytes / (1 << 20) << " MB, " << index_bytes / ram_bytes << " times RAM" << endl;
+
+        /*
+        Scanning the index, timing the evaluation and the client-side decryption
+        separately from the wall time. Each chunk of products is decrypted and
+        checked before the next chunk is read, so memory use does not grow with
+        the index.
+        */
+        vector<Ciphertext> product_vector;
+        product_vector.reserve(CHUNK_ROWS);
+        Ciphertext encrypted_row;
+        size_t num_results = 0;
+        bool all_within_tol = true;
+        int64_t compute_time = 0;
+        int64_t decrypt_time = 0;
+        auto check_chunk = [&]() {
+            auto decrypt_start = chrono::high_resolution_clock::now();
+            vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                if (abs(true_results[num_results + i] - results[i]) >= TOLERANCE)
+                {
+                    all_within_tol = false;
+                }
+            }
+            num_results += results.size();
+            product_vector.clear();
+            auto decrypt_end = chrono::high_resolution_clock::now();
+            decrypt_time += chrono::duration_cast<chrono::microseconds>(decrypt_end - decrypt_start).count();
+        };
+        auto time_start = chrono::high_resolution_clock::now();
+        while (reader.next(encrypted_row))
+        {
+            auto compute_start = chrono::high_resolution_clock::now();
+            product_vector.push_back(CKKS_dot_product(engine, encrypted_row, query));
+            auto compute_end = chrono::high_resolution_clock::now();
+            compute_time += chrono::duration_cast<chrono::microseconds>(compute_end - compute_start).count();
+            if (product_vector.size() == CHUNK_ROWS)
+            {
+                check_chunk();
+            }
+        }
+        if (!product_vector.empty())
+        {
+            check_chunk();
+        }
+        auto time_end = chrono::high_resolution_clock::now();
+        int64_t total_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        ReaderStats stats = reader.stats();
+        all_within_tol = all_within_tol && num_results == true_results.size();
+
+        cout << "Scan time: " << total_time / 1000 << " milliseconds" << endl;
+        cout << "Achieved read bandwidth: " << stats.bytes_read / (total_time * 1.048576) << " MB/s, storage alone: "
+             << (stats.read_microseconds > 0 ? stats.bytes_read * max<size_t>(config.second, 1) / (stats.read_microseconds * 1.048576) : 0)
+             << " MB/s" << endl;
+        cout << "Compute utilization: " << 100.0 * compute_time / total_time << "%, time waiting on storage: "
+             << stats.wait_microseconds / 1000 << " milliseconds" << endl;
+        cout << "Client decryption and checking: " << decrypt_time / 1000 << " milliseconds" << endl;
+        cout << "All deviations are within the tolerance: " << boolalpha << all_within_tol << endl;
+    }
+    remove(INDEX_PATH.c_str());
+    cout << endl;
+}
@@ -0,0 +1,145 @@
+#include "native/examples/examples.h"
+#include "capacity_planner.h"
+#include "ipc_utils.h"
+#include "my_utils.h"
+#include "query_service.h"
+
+using namespace std;
+using namespace seal;
+
+void test_capacity_planner()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 64;                       // Size of the full run that checks the plan
+    const vector<size_t> TARGET_EMBEDDINGS = { 100000, 1000000 };
+    const size_t REPS = 20;
+    const size_t MAX_THREADS = max<size_t>(1, thread::hardware_concurrency());
+
+    print_example_banner("Test: Capacity Planner");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    vector<size_t> thread_counts = { 1 };
+    if (MAX_THREADS > 1)
+    {
+        thread_counts.push_back(MAX_THREADS);
+    }
+
+    /* Calibrating, then planning for the target sizes */
+    CapacityPlanner planner(context, scale, DIMENSION, thread_counts);
+    cout << "Calibration took " << planner.calibration_ms() << " milliseconds" << endl;
+    for (size_t num_embeddings : TARGET_EMBEDDINGS)
+    {
+        print_line(__LINE__);
+        print_capacity_plan(planner.plan(num_embeddings));
+    }
+
+    /* Setting up keys and object instances for the full run */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /* Checking the plan for the size of the full run against what it actually uses */
+    print_line(__LINE__);
+    CapacityPlan plan = planner.plan(NUM_ROWS * num_vecs_per_row);
+    print_capacity_plan(plan);
+
+    size_t memory_bytes = 0;
+    for (auto &encrypted_row : encrypted_matrix)
+    {
+        memory_bytes += encrypted_row.size() * encrypted_row.poly_modulus_degree() * encrypted_row.coeff_modulus_size() * sizeof(uint64_t);
+    }
+    size_t disk_bytes = serialize_ciphertexts(encrypted_matrix, best_compr_mode()).size() - sizeof(uint64_t);
+
+    auto error = [](double predicted, double measured) {
+        return measured > 0 ? 100.0 * (predicted - measured) / measured : 0.0;
+    };
+    cout << endl << "Measured in the full run:" << endl;
+    cout << "Ciphertexts: " << encrypted_matrix.size() << " (predicted " << plan.num_ciphertexts << ")" << endl;
+    cout << "Rows in memory: " << memory_bytes / 1048576.0 << " MB (prediction off by " << error(plan.memory_bytes, memory_bytes)
+         << "%)" << endl;
+    cout << "Rows on disk: " << disk_bytes / 1048576.0 << " MB (prediction off by " << error(plan.disk_bytes, disk_bytes) << "%)"
+         << endl;
+
+    for (size_t i = 0; i < thread_counts.size(); i++)
+    {
+        vector<int64_t> latencies(REPS);
+        for (size_t rep = 0; rep < REPS; rep++)
+        {
+            auto time_start = chrono::high_resolution_clock::now();
+            Plaintext plain_vector;
+            encoder.encode(duplicated_vec, scale, plain_vector);
+            Ciphertext encrypted_vector;
+            encryptor.encrypt(plain_vector, encrypted_vector);
+            PreparedQuery query = prepare_query(context, evaluator, encrypted_vector, encrypted_matrix[0].parms_id());
+            vector<Ciphertext> product_vector = parallel_CKKS_matrix_vector_product(
+                evaluator, relin_keys, galois_keys, encrypted_matrix, query, DIMENSION, thread_counts[i]
+            );
+            vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+            auto time_end = chrono::high_resolution_clock::now();
+            latencies[rep] = chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        }
+        double p50_ms = percentile(latencies, 0.5) / 1000.0;
+        double p99_ms = percentile(latencies, 0.99) / 1000.0;
+        cout << "Threads: " << thread_counts[i] << ", latency p50: " << p50_ms << " ms (prediction off by "
+             << error(plan.p50_ms[i], p50_ms) << "%), p99: " << p99_ms << " ms (prediction off by "
+             << error(plan.p99_ms[i], p99_ms) << "%)" << endl;
+    }
+    cout << endl;
+}
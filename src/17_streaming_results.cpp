@@ -0,0 +1,145 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+#include "result_stream.h"
+
+using namespace std;
+using namespace seal;
+
+void test_streaming_results()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 64;
+    const size_t K = 10;
+    const double TOLERANCE = 1e-4;
+    const vector<size_t> CHUNK_SIZES = { NUM_ROWS, 16, 4, 1 };
+
+    print_example_banner("Test: Streaming Results");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+    cout << "k: " << K << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /* Encoding and encrypting vector */
+    Plaintext plain_vector;
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+    PreparedQuery query = prepare_query(context, evaluator, encrypted_vector, encrypted_matrix[0].parms_id());
+    vector<double> true_results = packed_matrix_vec_product(matrix, duplicated_vec, DIMENSION);
+    vector<size_t> true_top_k = top_k_indices(true_results, K);
+
+    for (size_t chunk_size : CHUNK_SIZES)
+    {
+        print_line(__LINE__);
+        cout << "Chunks of " << chunk_size << " rows" << (chunk_size == NUM_ROWS ? " (no streaming)" : "") << endl;
+
+        /* The server evaluates on its own thread, and the client decrypts and merges each chunk as it arrives */
+        ResultChannel channel;
+        auto time_start = chrono::high_resolution_clock::now();
+        thread server([&]() {
+            streaming_CKKS_matrix_vector_product(
+                evaluator, relin_keys, galois_keys, encrypted_matrix, query, DIMENSION, chunk_size,
+                [&](ResultChunk &chunk) { channel.push(move(chunk)); }
+            );
+            channel.close();
+        });
+
+        RunningTopK top_k(K);
+        ResultChunk chunk;
+        chrono::high_resolution_clock::time_point time_first;
+        bool is_first = true;
+        while (channel.pop(chunk))
+        {
+            vector<double> scores = packed_CKKS_results(decryptor, encoder, chunk.products, DIMENSION, num_vecs_per_row);
+            top_k.merge(scores, chunk.first_row * num_vecs_per_row);
+            if (is_first)
+            {
+                time_first = chrono::high_resolution_clock::now();
+                is_first = false;
+            }
+        }
+        auto time_end = chrono::high_resolution_clock::now();
+        server.join();
+
+        /* Scores can tie within the tolerance, so the top k are compared by score */
+        vector<pair<double, size_t>> best = top_k.top();
+        bool all_within_tol = best.size() == K;
+        for (size_t i = 0; all_within_tol && i < K; i++)
+        {
+            if (abs(best[i].first - true_results[true_top_k[i]]) >= TOLERANCE
+                || abs(best[i].first - true_results[best[i].second]) >= TOLERANCE)
+            {
+                all_within_tol = false;
+            }
+        }
+
+        cout << "Time to first result: " << chrono::duration_cast<chrono::microseconds>(time_first - time_start).count() / 1000
+             << " milliseconds" << endl;
+        cout << "Time to complete: " << chrono::duration_cast<chrono::microseconds>(time_end - time_start).count() / 1000
+             << " milliseconds" << endl;
+        cout << "Top " << K << " scores are within the tolerance: " << boolalpha << all_within_tol << endl;
+    }
+    cout << endl;
+}
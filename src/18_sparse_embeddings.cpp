@@ -0,0 +1,186 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+#include "sparse_index.h"
+
+using namespace std;
+using namespace seal;
+
+void test_sparse_embeddings()
+{
+    /* Parameters for the test */
+    const size_t NUM_DIMENSIONS = 512;
+    const size_t NUM_DOCS = 2048;
+    const vector<size_t> NON_ZEROS = { 4, 16, 64 };   // Per document and query
+    const double TOLERANCE = 1e-4;
+    const size_t REPS = 3;
+
+    print_example_banner("Test: Sparse Embeddings");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / NUM_DIMENSIONS;
+    size_t num_rows = (NUM_DOCS + num_vecs_per_row - 1) / num_vecs_per_row;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Number of dimensions: " << NUM_DIMENSIONS << endl;
+    cout << "Number of documents: " << NUM_DOCS << endl;
+
+    /* Setting up PRNG, with a few dimensions much more common than the rest, as in keyword vectors */
+    uniform_real_distribution<double> unif(0, 1);
+    vector<double> weights(NUM_DIMENSIONS);
+    for (size_t d = 0; d < NUM_DIMENSIONS; d++)
+    {
+        weights[d] = 1.0 / (d + 1);
+    }
+    discrete_distribution<uint32_t> random_dimension(weights.begin(), weights.end());
+    random_device rd;
+    mt19937 gen(rd());
+
+    auto random_sparse_vector = [&](size_t non_zeros) {
+        SparseVector vec;
+        while (vec.indices.size() < non_zeros)
+        {
+            uint32_t d = random_dimension(gen);
+            if (find(vec.indices.begin(), vec.indices.end(), d) == vec.indices.end())
+            {
+                vec.indices.push_back(d);
+                vec.values.push_back(unif(gen));
+            }
+        }
+        return vec;
+    };
+    auto densify = [&](const SparseVector &vec) {
+        vector<double> dense(NUM_DIMENSIONS, 0ULL);
+        for (size_t i = 0; i < vec.indices.size(); i++)
+        {
+            dense[vec.indices[i]] = vec.values[i];
+        }
+        return dense;
+    };
+
+    chrono::high_resolution_clock::time_point time_start, time_end;
+    for (size_t non_zeros : NON_ZEROS)
+    {
+        print_line(__LINE__);
+        cout << "Non-zero values per vector: " << non_zeros << " (" << 100.0 * non_zeros / NUM_DIMENSIONS << "%)" << endl;
+
+        vector<SparseVector> documents(NUM_DOCS);
+        for (auto &document : documents)
+        {
+            document = random_sparse_vector(non_zeros);
+        }
+        SparseVector query = random_sparse_vector(non_zeros);
+        vector<double> dense_query = densify(query);
+        vector<double> true_results(NUM_DOCS);
+        for (size_t doc = 0; doc < NUM_DOCS; doc++)
+        {
+            true_results[doc] = vec_float_dot_product(densify(documents[doc]), dense_query, NUM_DIMENSIONS);
+        }
+
+        /* Dense path: documents packed into rows as in Test 5, zeros included */
+        vector<vector<double>> matrix(num_rows, vector<double>(slot_count, 0ULL));
+        for (size_t doc = 0; doc < NUM_DOCS; doc++)
+        {
+            vector<double> dense = densify(documents[doc]);
+            copy(dense.begin(), dense.end(), matrix[doc / num_vecs_per_row].begin() + (doc % num_vecs_per_row) * NUM_DIMENSIONS);
+        }
+        vector<Ciphertext> encrypted_matrix(num_rows);
+        CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+
+        vector<double> duplicated_vec(slot_count);
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            duplicated_vec[j] = dense_query[j % NUM_DIMENSIONS];
+        }
+        Plaintext plain_vector;
+        encoder.encode(duplicated_vec, scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        PreparedQuery prepared = prepare_query(context, evaluator, encrypted_vector, encrypted_matrix[0].parms_id());
+
+        vector<Ciphertext> product_vector;
+        time_start = chrono::high_resolution_clock::now();
+        for (size_t rep = 0; rep < REPS; rep++)
+        {
+            product_vector = CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, prepared, NUM_DIMENSIONS);
+        }
+        time_end = chrono::high_resolution_clock::now();
+        auto dense_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+        vector<double> dense_results = packed_CKKS_results(decryptor, encoder, product_vector, NUM_DIMENSIONS, num_vecs_per_row);
+        encrypted_matrix.clear();
+
+        /* Sparse path: per-dimension postings, and only the non-zero query values */
+        time_start = chrono::high_resolution_clock::now();
+        SparsePostingIndex index(context, public_key, scale, NUM_DIMENSIONS, documents);
+        time_end = chrono::high_resolution_clock::now();
+        auto build_time = chrono::duration_cast<chrono::milliseconds>(time_end - time_start);
+        vector<EncryptedQueryTerm> encrypted_query = encrypt_sparse_query(encoder, encryptor, query, scale);
+
+        vector<size_t> group_ids;
+        vector<Ciphertext> score_vector;
+        time_start = chrono::high_resolution_clock::now();
+        for (size_t rep = 0; rep < REPS; rep++)
+        {
+            score_vector = index.scores(evaluator, relin_keys, encrypted_query, group_ids);
+        }
+        time_end = chrono::high_resolution_clock::now();
+        auto sparse_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+
+        /* Groups without a posting in the query dimensions score zero */
+        vector<double> sparse_results(NUM_DOCS, 0);
+        for (size_t k = 0; k < group_ids.size(); k++)
+        {
+            vector<double> decoded;
+            decryptor.decrypt(score_vector[k], plain_vector);
+            encoder.decode(plain_vector, decoded);
+            for (size_t j = 0; j < slot_count && group_ids[k] * slot_count + j < NUM_DOCS; j++)
+            {
+                sparse_results[group_ids[k] * slot_count + j] = decoded[j];
+            }
+        }
+
+        bool dense_within_tol = true, sparse_within_tol = true;
+        for (size_t doc = 0; doc < NUM_DOCS; doc++)
+        {
+            dense_within_tol = dense_within_tol && abs(dense_results[doc] - true_results[doc]) < TOLERANCE;
+            sparse_within_tol = sparse_within_tol && abs(sparse_results[doc] - true_results[doc]) < TOLERANCE;
+        }
+
+        cout << "Dense: " << num_rows << " ciphertexts, " << REPS * NUM_DOCS * 1e6 / dense_time.count()
+             << " documents scored per second" << endl;
+        cout << "Sparse: " << index.num_postings() << " postings in " << index.num_groups() << " groups, built in "
+             << build_time.count() << " ms, " << encrypted_query.size() << " query ciphertexts, "
+             << REPS * NUM_DOCS * 1e6 / sparse_time.count() << " documents scored per second" << endl;
+        cout << "Speedup: " << static_cast<double>(dense_time.count()) / sparse_time.count() << endl;
+        cout << "All deviations are within the tolerance, dense: " << boolalpha << dense_within_tol << ", sparse: "
+             << sparse_within_tol << endl;
+    }
+    cout << endl;
+}
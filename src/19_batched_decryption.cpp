@@ -0,0 +1,138 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_batched_decryption()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 256;
+    const double TOLERANCE = 1e-4;
+    const size_t MAX_THREADS = max<size_t>(1, thread::hardware_concurrency());
+
+    print_example_banner("Test: Batched Result Decryption");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Number of result ciphertexts: " << NUM_ROWS << " (" << NUM_ROWS * num_vecs_per_row << " results)" << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /* Computing the result ciphertexts that the client receives */
+    Plaintext plain_vector;
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+    PreparedQuery query = prepare_query(context, evaluator, encrypted_vector, encrypted_matrix[0].parms_id());
+    vector<Ciphertext> product_vector =
+        parallel_CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, query, DIMENSION, MAX_THREADS);
+    vector<double> true_results = packed_matrix_vec_product(matrix, duplicated_vec, DIMENSION);
+
+    auto check_results = [&](vector<double> &results) {
+        for (size_t i = 0; i < true_results.size(); i++)
+        {
+            if (abs(true_results[i] - results[i]) >= TOLERANCE)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    /* Timing the serial decryption the tests use */
+    print_line(__LINE__);
+    auto time_start = chrono::high_resolution_clock::now();
+    vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+    auto time_end = chrono::high_resolution_clock::now();
+    auto serial_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+    cout << "packed_CKKS_results: " << serial_time.count() / 1000 << " milliseconds, within tolerance: " << boolalpha
+         << check_results(results) << endl;
+
+    vector<size_t> thread_counts;
+    for (size_t num_threads = 1; num_threads < MAX_THREADS; num_threads *= 2)
+    {
+        thread_counts.push_back(num_threads);
+    }
+    thread_counts.push_back(MAX_THREADS);
+
+    /* Timing the batched decoder, with and without switching to the last level */
+    for (bool switch_to_last_level : { false, true })
+    {
+        print_line(__LINE__);
+        cout << (switch_to_last_level ? "Switched to the last level" : "At the level of the results") << endl;
+        for (size_t num_threads : thread_counts)
+        {
+            vector<double> batched_results;
+            time_start = chrono::high_resolution_clock::now();
+            parallel_packed_CKKS_results(
+                context, secret_key, product_vector, DIMENSION, num_vecs_per_row, batched_results, num_threads, switch_to_last_level
+            );
+            time_end = chrono::high_resolution_clock::now();
+            auto time_diff = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+            cout << "Threads: " << num_threads << ", " << time_diff.count() / 1000 << " milliseconds, speedup: "
+                 << static_cast<double>(serial_time.count()) / time_diff.count() << ", within tolerance: "
+                 << check_results(batched_results) << endl;
+        }
+    }
+    cout << endl;
+}
@@ -0,0 +1,154 @@
+#include "native/examples/examples.h"
+#include "dot_product_engine.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_bfv_dot_product_engine()
+{
+    /* Parameters for the test */
+    const size_t NUM_ROWS = 64;
+    const size_t REPS = 5;
+
+    print_example_banner("Test: BFV Dot Product Engine");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::bfv);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::BFVDefault(poly_modulus_degree));
+    parms.set_plain_modulus(PlainModulus::Batching(poly_modulus_degree, 20));
+
+    /* Creating context, keys and object instances */
+    ProductTestSetup setup(parms);
+    print_parameters(setup.context);
+    cout << endl;
+
+    /* Blocks never straddle the two rows of the batching matrix, which rotate separately */
+    BatchEncoder batch_encoder(setup.context);
+    size_t slot_count = batch_encoder.slot_count();
+    uint64_t plain_modulus = parms.plain_modulus().value();
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+    cout << "Galois keys for every power of two: " << setup.galois_keys.size() << ", "
+         << setup.galois_keys.save_size(compr_mode_type::none) / (1 << 20) << " MB" << endl;
+
+    /* Setting up PRNG for integers below the plain modulus */
+    uniform_int_distribution<uint64_t> unif(0, plain_modulus - 1);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating, encoding and encrypting matrix */
+    vector<vector<uint64_t>> matrix(NUM_ROWS, vector<uint64_t>(slot_count, 0ULL));
+    Plaintext plain_row;
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+        batch_encoder.encode(matrix[i], plain_row);
+        setup.encryptor.encrypt(plain_row, encrypted_matrix[i]);
+    }
+
+    print_line(__LINE__);
+    cout << "Microseconds per row for the hand-written rotate and add loop, BFV_dot_product, the compile-time "
+         << "engine with only its own Galois keys, and the runtime engine" << endl;
+    cout << setw(11) << left << "Dimension" << right << setw(8) << "Keys" << setw(14) << "Baseline" << setw(14) << "Function"
+         << setw(14) << "Engine" << setw(14) << "Runtime" << setw(10) << "Speedup" << "    Correct" << endl;
+
+    /* The dimension is passed as a type, so that the compile-time engine can be instantiated with it */
+    auto compare = [&](auto dimension_constant) {
+        constexpr size_t DIMENSION = decltype(dimension_constant)::value;
+        size_t num_vecs_per_row = slot_count / DIMENSION;
+
+        /* Creating, encoding and encrypting duplicated vector */
+        vector<uint64_t> duplicated_vec(slot_count, 0ULL);
+        for (size_t i = 0; i < DIMENSION; i++)
+        {
+            uint64_t randVal = unif(gen);
+            for (size_t j = i; j < slot_count; j += DIMENSION)
+            {
+                duplicated_vec[j] = randVal;
+            }
+        }
+        Plaintext plain_vector;
+        batch_encoder.encode(duplicated_vec, plain_vector);
+        Ciphertext encrypted_vector;
+        setup.encryptor.encrypt(plain_vector, encrypted_vector);
+
+        /* The compile-time engine only gets the keys of its own rotations */
+        GaloisKeys engine_galois_keys;
+        DotProductEngine<BFVScheme, DIMENSION> engine(
+            setup.context, setup.evaluator, setup.relin_keys, engine_galois_keys
+        );
+        setup.keygen.create_galois_keys(engine.galois_elements(poly_modulus_degree), engine_galois_keys);
+        DotProductEngine<BFVScheme> runtime_engine(
+            setup.context, setup.evaluator, setup.relin_keys, setup.galois_keys, DIMENSION
+        );
+
+        /* The baseline is the loop the engine replaced, with a new rotated ciphertext for every step */
+        auto baseline = [&](Ciphertext &row, Ciphertext &product) {
+            setup.evaluator.multiply(row, encrypted_vector, product);
+            setup.evaluator.relinearize_inplace(product, setup.relin_keys);
+            for (size_t rotation_steps = DIMENSION / 2; rotation_steps >= 1; rotation_steps /= 2)
+            {
+                Ciphertext product_rotated;
+                setup.evaluator.rotate_rows(product, rotation_steps, setup.galois_keys, product_rotated);
+                setup.evaluator.add_inplace(product, product_rotated);
+            }
+        };
+        vector<product_variant> variants = {
+            baseline,
+            [&](Ciphertext &row, Ciphertext &product) {
+                product = BFV_dot_product(
+                    setup.evaluator, setup.relin_keys, setup.galois_keys, row, encrypted_vector, DIMENSION
+                );
+            },
+            [&](Ciphertext &row, Ciphertext &product) { engine.dot_product(row, encrypted_vector, product); },
+            [&](Ciphertext &row, Ciphertext &product) { runtime_engine.dot_product(row, encrypted_vector, product); }
+        };
+        vector<vector<Ciphertext>> product_vectors;
+        vector<int64_t> times = time_product_variants(variants, encrypted_matrix, product_vectors, REPS);
+
+        /* Checking the first slot of every block, modulo the plain modulus */
+        bool correct = true;
+        vector<uint64_t> decoded;
+        for (auto &product_vector : product_vectors)
+        {
+            for (size_t i = 0; i < NUM_ROWS; i++)
+            {
+                setup.decryptor.decrypt(product_vector[i], plain_vector);
+                batch_encoder.decode(plain_vector, decoded);
+                for (size_t b = 0; b < num_vecs_per_row; b++)
+                {
+                    uint64_t true_result = 0;
+                    for (size_t j = b * DIMENSION; j < (b + 1) * DIMENSION; j++)
+                    {
+                        true_result = (true_result + matrix[i][j] * duplicated_vec[j] % plain_modulus) % plain_modulus;
+                    }
+                    correct = correct && decoded[b * DIMENSION] == true_result;
+                }
+            }
+        }
+
+        /* The speedup is of the compile-time engine over the baseline */
+        cout << setw(11) << left << DIMENSION << right << setw(8) << engine_galois_keys.size() << fixed << setprecision(1);
+        for (int64_t time : times)
+        {
+            cout << setw(14) << static_cast<double>(time) / (REPS * NUM_ROWS);
+        }
+        cout << setprecision(2) << setw(10) << static_cast<double>(times[0]) / times[2] << "    " << boolalpha << correct
+             << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    };
+    compare(integral_constant<size_t, 128>());
+    compare(integral_constant<size_t, 256>());
+    compare(integral_constant<size_t, 512>());
+    compare(integral_constant<size_t, 1024>());
+    cout << endl;
+}
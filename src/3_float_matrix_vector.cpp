@@ -85,13 +85,7 @@ void test_float_matrix_vector_product()
     cout << "Encode and encrypt matrix." << endl;
 
     vector<Ciphertext> encrypted_matrix(NUM_ROWS);
-    for (size_t i = 0; i < NUM_ROWS; i++)
-    {
-        encoder.encode(matrix[i], scale, plain_vector);
-        Ciphertext encrypted_vector;
-        encryptor.encrypt(plain_vector, encrypted_vector);
-        encrypted_matrix[i] = encrypted_vector;
-    }
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
 
     /* Creating vector */
     vector<double> vec(slot_count, 0ULL);
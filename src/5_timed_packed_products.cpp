@@ -1,5 +1,7 @@
 #include "native/examples/examples.h"
 #include "my_utils.h"
+#include "perf_counters.h"
+#include <optional>
 
 using namespace std;
 using namespace seal;
@@ -13,6 +15,7 @@ unsigned long timed_test_with_num_rows(SEALContext context, size_t NUM_ROWS)
     const double TOLERANCE = 1e-4;
     const size_t REPS = 10;
     const bool ONE_ROW_MATRIX = false;
+    const bool PROFILE_PHASES = false;
 
     /* Setting scale */
     double scale = pow(2.0, 40);
@@ -75,6 +78,13 @@ unsigned long timed_test_with_num_rows(SEALContext context, size_t NUM_ROWS)
     vector<int64_t> times(REPS);
     chrono::milliseconds time_sum(0);
     chrono::milliseconds time_diff;
+
+    /* The profiler opens the perf counters, so it only exists when the phases are profiled */
+    optional<PhaseProfiler> profiler;
+    if (PROFILE_PHASES)
+    {
+        profiler.emplace();
+    }
     
 
     for (size_t i = 0; i < REPS; i++)
@@ -92,13 +102,7 @@ unsigned long timed_test_with_num_rows(SEALContext context, size_t NUM_ROWS)
         /* Encoding and encrypting matrix */
         Plaintext plain_vector;
         vector<Ciphertext> encrypted_matrix(NUM_ROWS);
-        for (size_t i = 0; i < NUM_ROWS; i++)
-        {
-            encoder.encode(matrix[i], scale, plain_vector);
-            Ciphertext encrypted_vector;
-            encryptor.encrypt(plain_vector, encrypted_vector);
-            encrypted_matrix[i] = encrypted_vector;
-        }
+        CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
 
         /* Creating duplicated vector */
         vector<double> duplicated_vec(slot_count, 0ULL);
@@ -137,6 +141,15 @@ unsigned long timed_test_with_num_rows(SEALContext context, size_t NUM_ROWS)
             cerr << "An absolute deviation was not within the tolerance." << endl;
         }
 
+        /* Profiling the phases in an untimed pass after the last timed one */
+        if (PROFILE_PHASES && i == REPS - 1)
+        {
+            product_vector = profiled_CKKS_matrix_vector_product(
+                evaluator, relin_keys, galois_keys, encrypted_matrix, encrypted_vector, DIMENSION, *profiler
+            );
+            profiled_packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row, *profiler);
+        }
+
         /* Record time */
         times[i] = time_diff.count();
         time_sum += time_diff;
@@ -149,6 +162,12 @@ unsigned long timed_test_with_num_rows(SEALContext context, size_t NUM_ROWS)
     /* Print average time */
     auto avg_time = time_sum.count() / REPS;
     cout << "Average time: " << avg_time << " milliseconds" << endl;
+
+    /* Print the phase breakdown */
+    if (PROFILE_PHASES)
+    {
+        profiler->print_report(NUM_ROWS);
+    }
     return avg_time;
 }
 
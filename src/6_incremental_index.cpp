@@ -0,0 +1,196 @@
+#include "native/examples/examples.h"
+#include "encrypted_index.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_incremental_index()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const vector<size_t> INDEX_SIZES = { 8, 32, 128 };  // In rows
+    const size_t NUM_CHANGES = 32;
+    const double TOLERANCE = 1e-4;
+
+    print_example_banner("Test: Incremental Index Updates");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Dimension of vectors: " << DIMENSION << endl;
+    cout << "Number of vectors per row: " << num_vecs_per_row << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    auto random_embedding = [&]() {
+        vector<double> embedding(DIMENSION);
+        for (size_t i = 0; i < DIMENSION; i++)
+        {
+            embedding[i] = unif(gen);
+        }
+        return embedding;
+    };
+
+    chrono::high_resolution_clock::time_point time_start, time_end;
+    for (size_t num_rows : INDEX_SIZES)
+    {
+        size_t num_vecs = num_rows * num_vecs_per_row;
+        print_line(__LINE__);
+        cout << "Index of " << num_rows << " rows (" << num_vecs << " vectors)." << endl;
+
+        /* Filling the index, keeping the plaintext embeddings on the owner side */
+        EncryptedIndex index(context, public_key, scale, DIMENSION);
+        vector<vector<double>> embeddings(num_vecs);
+        vector<bool> used(num_vecs, false);
+        for (size_t i = 0; i < num_vecs; i++)
+        {
+            vector<double> embedding = random_embedding();
+            size_t block_id = index.insert(embedding);
+            embeddings[block_id] = embedding;
+            used[block_id] = true;
+        }
+
+        /* Timing a full rebuild of one row, which is what changing one embedding used to cost */
+        vector<double> row_vec(slot_count, 0ULL);
+        Plaintext plain_vector;
+        Ciphertext encrypted_row;
+        time_start = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < num_rows; i++)
+        {
+            encoder.encode(row_vec, scale, plain_vector);
+            encryptor.encrypt(plain_vector, encrypted_row);
+        }
+        time_end = chrono::high_resolution_clock::now();
+        auto rebuild_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+
+        /* Timing updates of random blocks */
+        uniform_int_distribution<size_t> random_block(0, num_vecs - 1);
+        time_start = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < NUM_CHANGES; i++)
+        {
+            size_t block_id = random_block(gen);
+            vector<double> embedding = random_embedding();
+            index.update(block_id, embeddings[block_id], embedding);
+            embeddings[block_id] = embedding;
+        }
+        time_end = chrono::high_resolution_clock::now();
+        auto update_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+
+        /* Timing deletes of the whole first row and some random blocks of the other rows */
+        vector<size_t> removed;
+        for (size_t block_id = 0; block_id < num_vecs_per_row; block_id++)
+        {
+            removed.push_back(block_id);
+        }
+        while (removed.size() < num_vecs_per_row + NUM_CHANGES)
+        {
+            size_t block_id = random_block(gen);
+            if (block_id >= num_vecs_per_row && find(removed.begin(), removed.end(), block_id) == removed.end())
+            {
+                removed.push_back(block_id);
+            }
+        }
+        time_start = chrono::high_resolution_clock::now();
+        for (size_t block_id : removed)
+        {
+            index.remove(block_id, embeddings[block_id]);
+            used[block_id] = false;
+        }
+        time_end = chrono::high_resolution_clock::now();
+        auto remove_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+
+        /* Compacting in the background while inserting into the freed blocks outside of the first row */
+        index.start_compaction();
+        size_t num_inserts = NUM_CHANGES;
+        time_start = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < num_inserts; i++)
+        {
+            vector<double> embedding = random_embedding();
+            size_t block_id = index.insert(embedding);
+            embeddings[block_id] = embedding;
+            used[block_id] = true;
+        }
+        time_end = chrono::high_resolution_clock::now();
+        auto insert_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start);
+        index.wait_for_compaction();
+
+        cout << "Average time to rebuild one row: " << rebuild_time.count() / num_rows << " microseconds" << endl;
+        cout << "Average time per update: " << update_time.count() / NUM_CHANGES << " microseconds" << endl;
+        cout << "Average time per delete: " << remove_time.count() / removed.size() << " microseconds" << endl;
+        cout << "Average time per insert: " << insert_time.count() / num_inserts << " microseconds" << endl;
+        cout << "Live rows after compaction: " << index.num_live_rows() << " of " << index.num_rows() << endl;
+        cout << "Used blocks: " << index.num_used_blocks() << ", free blocks: " << index.num_free_blocks() << endl;
+
+        /* Creating duplicated vector */
+        vector<double> duplicated_vec(slot_count, 0ULL);
+        for (size_t i = 0; i < DIMENSION; i++)
+        {
+            double randVal = unif(gen);
+            for (size_t j = i; j < slot_count; j += DIMENSION)
+            {
+                duplicated_vec[j] = randVal;
+            }
+        }
+
+        /* Encoding and encrypting vector */
+        encoder.encode(duplicated_vec, scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+
+        /* Evaluating over the index and checking every block against the plaintext embeddings */
+        vector<size_t> row_ids;
+        vector<Ciphertext> product_vector = index.matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_vector, row_ids);
+        vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+
+        bool all_within_tol = true;
+        for (size_t k = 0; k < row_ids.size(); k++)
+        {
+            for (size_t j = 0; j < num_vecs_per_row; j++)
+            {
+                size_t block_id = row_ids[k] * num_vecs_per_row + j;
+                double true_result = used[block_id] ? vec_float_dot_product(embeddings[block_id], duplicated_vec, DIMENSION) : 0;
+                if (abs(true_result - results[k * num_vecs_per_row + j]) >= TOLERANCE)
+                {
+                    all_within_tol = false;
+                }
+            }
+        }
+        cout << "The tolerance is: " << TOLERANCE << endl;
+        cout << "All deviations are within the tolerance: " << boolalpha << all_within_tol << endl << endl;
+    }
+}
@@ -0,0 +1,165 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+#include "sharding.h"
+
+using namespace std;
+using namespace seal;
+
+void test_sharded_products()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 32;
+    const double TOLERANCE = 1e-4;
+    const size_t REPS = 5;
+    const size_t MAX_WORKERS = max<size_t>(1, thread::hardware_concurrency());
+
+    print_example_banner("Test: Sharded Packed Matrix Vector Product");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Dimension of vectors: " << DIMENSION << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+    cout << "Total number of unpacked vectors: " << num_vecs_per_row * NUM_ROWS << endl;
+    cout << "Maximum number of workers: " << MAX_WORKERS << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+
+    /* Encoding and encrypting matrix */
+    Plaintext plain_vector;
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        encoder.encode(matrix[i], scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        encrypted_matrix[i] = encrypted_vector;
+    }
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+
+    /* Encoding and encrypting vector */
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+
+    vector<double> true_results = packed_matrix_vec_product(matrix, duplicated_vec, DIMENSION);
+
+    /* Timing the single process product as the baseline */
+    print_line(__LINE__);
+    chrono::high_resolution_clock::time_point time_start, time_end;
+    time_start = chrono::high_resolution_clock::now();
+    for (size_t rep = 0; rep < REPS; rep++)
+    {
+        CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, encrypted_vector, DIMENSION);
+    }
+    time_end = chrono::high_resolution_clock::now();
+    int64_t baseline_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start).count() / REPS;
+    cout << "Single process average time: " << baseline_time / 1000 << " milliseconds" << endl;
+
+    /* Scaling from 1 to MAX_WORKERS workers */
+    vector<size_t> worker_counts;
+    for (size_t num_workers = 1; num_workers < MAX_WORKERS; num_workers *= 2)
+    {
+        worker_counts.push_back(num_workers);
+    }
+    worker_counts.push_back(MAX_WORKERS);
+
+    for (size_t num_workers : worker_counts)
+    {
+        print_line(__LINE__);
+        cout << "Running with " << num_workers << " workers." << endl;
+        ShardCoordinator coordinator(context, relin_keys, galois_keys, encrypted_matrix, DIMENSION, num_workers);
+
+        ShardTimings sum;
+        vector<Ciphertext> product_vector;
+        for (size_t rep = 0; rep < REPS; rep++)
+        {
+            product_vector = coordinator.matrix_vector_product(encrypted_vector);
+            ShardTimings timings = coordinator.last_timings();
+            sum.total += timings.total;
+            sum.serialize_query += timings.serialize_query;
+            sum.deserialize_results += timings.deserialize_results;
+            sum.max_worker_compute += timings.max_worker_compute;
+            sum.max_worker_serialize += timings.max_worker_serialize;
+            sum.query_bytes = timings.query_bytes;
+            sum.result_bytes = timings.result_bytes;
+        }
+
+        /* Checking the gathered results against the plaintext results */
+        vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+        bool all_within_tol = true;
+        for (size_t i = 0; i < true_results.size(); i++)
+        {
+            if (abs(true_results[i] - results[i]) >= TOLERANCE)
+            {
+                all_within_tol = false;
+            }
+        }
+
+        int64_t avg_total = sum.total / REPS;
+        cout << "Average time: " << avg_total / 1000 << " milliseconds" << endl;
+        cout << "Speedup over single process: " << static_cast<double>(baseline_time) / avg_total << endl;
+        cout << "Average slowest worker compute: " << sum.max_worker_compute / REPS / 1000 << " milliseconds" << endl;
+        cout << "Average query serialization: " << sum.serialize_query / REPS << " microseconds" << endl;
+        cout << "Average slowest worker result serialization: " << sum.max_worker_serialize / REPS << " microseconds" << endl;
+        cout << "Average result deserialization: " << sum.deserialize_results / REPS << " microseconds" << endl;
+        cout << "Query bytes per worker: " << sum.query_bytes << ", result bytes: " << sum.result_bytes << endl;
+        cout << "All deviations are within the tolerance: " << boolalpha << all_within_tol << endl;
+    }
+    cout << endl;
+}
@@ -0,0 +1,175 @@
+#include "native/examples/examples.h"
+#include "my_utils.h"
+#include "query_service.h"
+
+using namespace std;
+using namespace seal;
+
+void test_query_service()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 16;
+    const double TOLERANCE = 1e-4;
+    const vector<size_t> CONCURRENCY = { 1, 2, 4 };
+    const size_t QUERIES_PER_CLIENT = 5;
+
+    print_example_banner("Test: Loopback Query Service");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Dimension of vectors: " << DIMENSION << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+    cout << "Total number of unpacked vectors: " << num_vecs_per_row * NUM_ROWS << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+
+    /* Encoding and encrypting matrix */
+    Plaintext plain_vector;
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        encoder.encode(matrix[i], scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        encrypted_matrix[i] = encrypted_vector;
+    }
+
+    /* Creating duplicated vector */
+    vector<double> duplicated_vec(slot_count, 0ULL);
+    for (size_t i = 0; i < DIMENSION; i++)
+    {
+        double randVal = unif(gen);
+        for (size_t j = i; j < slot_count; j += DIMENSION)
+        {
+            duplicated_vec[j] = randVal;
+        }
+    }
+    encoder.encode(duplicated_vec, scale, plain_vector);
+    vector<double> true_results = packed_matrix_vec_product(matrix, duplicated_vec, DIMENSION);
+
+    /* Timing the in-process product for comparison */
+    print_line(__LINE__);
+    Ciphertext encrypted_vector;
+    encryptor.encrypt(plain_vector, encrypted_vector);
+    chrono::high_resolution_clock::time_point time_start, time_end;
+    time_start = chrono::high_resolution_clock::now();
+    CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, encrypted_vector, DIMENSION);
+    time_end = chrono::high_resolution_clock::now();
+    cout << "In-process evaluation time: " << chrono::duration_cast<chrono::milliseconds>(time_end - time_start).count()
+         << " milliseconds" << endl;
+
+    /* The client encrypts with the secret key so that queries are sent seeded */
+    Encryptor symmetric_encryptor(context, secret_key);
+
+    vector<compr_mode_type> compr_modes = { compr_mode_type::none };
+    if (best_compr_mode() != compr_mode_type::none)
+    {
+        compr_modes.push_back(best_compr_mode());
+    }
+
+    for (compr_mode_type compr_mode : compr_modes)
+    {
+        QueryServer server(context, relin_keys, galois_keys, encrypted_matrix, DIMENSION, compr_mode);
+        for (size_t num_clients : CONCURRENCY)
+        {
+            print_line(__LINE__);
+            cout << "Compression: " << (compr_mode == compr_mode_type::none ? "none" : "enabled") << ", concurrent clients: "
+                 << num_clients << endl;
+
+            vector<int64_t> latencies(num_clients * QUERIES_PER_CLIENT);
+            vector<size_t> query_bytes(num_clients), result_bytes(num_clients);
+            vector<int> within_tol(num_clients, 1);
+            vector<thread> clients;
+            for (size_t c = 0; c < num_clients; c++)
+            {
+                clients.emplace_back([&, c]() {
+                    QueryClient client(context, server.port());
+                    Decryptor decryptor(context, secret_key);
+                    CKKSEncoder client_encoder(context);
+                    for (size_t q = 0; q < QUERIES_PER_CLIENT; q++)
+                    {
+                        /* End-to-end: encrypt, serialize, transfer, evaluate, return and deserialize */
+                        auto query_start = chrono::high_resolution_clock::now();
+                        string encoded_query = encode_query(symmetric_encryptor.encrypt_symmetric(plain_vector), compr_mode);
+                        vector<Ciphertext> product_vector = client.query(encoded_query, result_bytes[c]);
+                        auto query_end = chrono::high_resolution_clock::now();
+                        latencies[c * QUERIES_PER_CLIENT + q] =
+                            chrono::duration_cast<chrono::microseconds>(query_end - query_start).count();
+                        query_bytes[c] = encoded_query.size();
+
+                        /* Checking the results of the first query of each client */
+                        if (q == 0)
+                        {
+                            vector<double> results =
+                                packed_CKKS_results(decryptor, client_encoder, product_vector, DIMENSION, num_vecs_per_row);
+                            for (size_t i = 0; i < true_results.size(); i++)
+                            {
+                                if (abs(true_results[i] - results[i]) >= TOLERANCE)
+                                {
+                                    within_tol[c] = 0;
+                                }
+                            }
+                        }
+                    }
+                });
+            }
+            for (thread &client : clients)
+            {
+                client.join();
+            }
+
+            cout << "Bytes on the wire per query: " << query_bytes[0] << " sent, " << result_bytes[0] << " received" << endl;
+            cout << "End-to-end latency p50: " << percentile(latencies, 0.5) / 1000 << " ms, p90: "
+                 << percentile(latencies, 0.9) / 1000 << " ms, p99: " << percentile(latencies, 0.99) / 1000
+                 << " ms, max: " << percentile(latencies, 1.0) / 1000 << " ms" << endl;
+            cout << "All deviations are within the tolerance: " << boolalpha
+                 << all_of(within_tol.begin(), within_tol.end(), [](int ok) { return ok == 1; }) << endl;
+        }
+    }
+    cout << endl;
+}
@@ -0,0 +1,170 @@
+#include "native/examples/examples.h"
+#include "batch_scheduler.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+void test_batched_scheduler()
+{
+    /* Parameters for the test */
+    const size_t DIMENSION = 128;
+    const double UPPER_BOUND = 1;
+    const double LOWER_BOUND = 0;
+    const size_t NUM_ROWS = 8;
+    const double TOLERANCE = 1e-4;
+    const size_t NUM_QUERIES = 32;
+    const double MEAN_ARRIVAL_INTERVAL_MS = 20;
+    const vector<int64_t> BATCH_WINDOWS_MS = { 0, 10, 50 };
+    const size_t MAX_BATCH_SIZE = 8;
+
+    print_example_banner("Test: Batched Query Scheduler");
+
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+
+    size_t poly_modulus_degree = 8192;
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, { 60, 40, 40, 60 }));
+
+    /* Setting scale */
+    double scale = pow(2.0, 40);
+
+    /* Creating context */
+    SEALContext context(parms);
+    print_parameters(context);
+    cout << endl;
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Decryptor decryptor(context, secret_key);
+
+    CKKSEncoder encoder(context);
+    size_t slot_count = encoder.slot_count();
+    size_t num_vecs_per_row = slot_count / DIMENSION;
+    cout << "Number of slots: " << slot_count << endl;
+    cout << "Dimension of vectors: " << DIMENSION << endl;
+    cout << "Number of rows: " << NUM_ROWS << endl;
+    cout << "Number of queries: " << NUM_QUERIES << endl;
+    cout << "Mean time between queries: " << MEAN_ARRIVAL_INTERVAL_MS << " milliseconds" << endl;
+
+    /* Setting up PRNG for doubles */
+    uniform_real_distribution<double> unif(LOWER_BOUND, UPPER_BOUND);
+    random_device rd;
+    mt19937 gen(rd());
+
+    /* Creating matrix */
+    vector<vector<double>> matrix(NUM_ROWS, vector<double>(slot_count, 0ULL));
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        for (size_t j = 0; j < slot_count; j++)
+        {
+            matrix[i][j] = unif(gen);
+        }
+    }
+
+    /* Encoding and encrypting matrix */
+    Plaintext plain_vector;
+    vector<Ciphertext> encrypted_matrix(NUM_ROWS);
+    for (size_t i = 0; i < NUM_ROWS; i++)
+    {
+        encoder.encode(matrix[i], scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        encrypted_matrix[i] = encrypted_vector;
+    }
+
+    /* Creating and encrypting one duplicated vector per query */
+    vector<vector<double>> duplicated_vecs(NUM_QUERIES, vector<double>(slot_count, 0ULL));
+    vector<Ciphertext> encrypted_vectors(NUM_QUERIES);
+    for (size_t q = 0; q < NUM_QUERIES; q++)
+    {
+        for (size_t i = 0; i < DIMENSION; i++)
+        {
+            double randVal = unif(gen);
+            for (size_t j = i; j < slot_count; j += DIMENSION)
+            {
+                duplicated_vecs[q][j] = randVal;
+            }
+        }
+        encoder.encode(duplicated_vecs[q], scale, plain_vector);
+        encryptor.encrypt(plain_vector, encrypted_vectors[q]);
+    }
+
+    /* The same arrival times are replayed for every window */
+    exponential_distribution<double> arrival(1.0 / MEAN_ARRIVAL_INTERVAL_MS);
+    vector<double> arrival_intervals(NUM_QUERIES);
+    for (size_t q = 0; q < NUM_QUERIES; q++)
+    {
+        arrival_intervals[q] = arrival(gen);
+    }
+
+    for (int64_t window_ms : BATCH_WINDOWS_MS)
+    {
+        size_t max_batch_size = window_ms == 0 ? 1 : MAX_BATCH_SIZE;
+        print_line(__LINE__);
+        cout << "Batch window: " << window_ms << " milliseconds, maximum batch size: " << max_batch_size << endl;
+
+        vector<future<vector<Ciphertext>>> futures;
+        SchedulerStats stats;
+        auto time_start = chrono::high_resolution_clock::now();
+        {
+            BatchScheduler scheduler(
+                context, relin_keys, galois_keys, encrypted_matrix, DIMENSION, chrono::milliseconds(window_ms), max_batch_size
+            );
+            for (size_t q = 0; q < NUM_QUERIES; q++)
+            {
+                this_thread::sleep_for(chrono::duration<double, milli>(arrival_intervals[q]));
+                futures.push_back(scheduler.submit(encrypted_vectors[q]));
+            }
+            for (size_t q = 0; q < NUM_QUERIES; q++)
+            {
+                futures[q].wait();
+            }
+            stats = scheduler.stats();
+        }
+        auto time_end = chrono::high_resolution_clock::now();
+        auto time_diff = chrono::duration_cast<chrono::milliseconds>(time_end - time_start);
+
+        /* Checking the last query against its plaintext results */
+        vector<Ciphertext> product_vector = futures.back().get();
+        vector<double> results = packed_CKKS_results(decryptor, encoder, product_vector, DIMENSION, num_vecs_per_row);
+        vector<double> true_results = packed_matrix_vec_product(matrix, duplicated_vecs.back(), DIMENSION);
+        bool all_within_tol = true;
+        for (size_t i = 0; i < true_results.size(); i++)
+        {
+            if (abs(true_results[i] - results[i]) >= TOLERANCE)
+            {
+                all_within_tol = false;
+            }
+        }
+
+        /* Batch size distribution, indexed by batch size */
+        vector<size_t> batch_size_counts(max_batch_size + 1, 0);
+        for (size_t batch_size : stats.batch_sizes)
+        {
+            batch_size_counts[batch_size]++;
+        }
+        size_t max_queue_depth = *max_element(stats.queue_depths.begin(), stats.queue_depths.end());
+        double avg_queue_depth = accumulate(stats.queue_depths.begin(), stats.queue_depths.end(), 0.0) / stats.queue_depths.size();
+
+        cout << "Total time: " << time_diff.count() << " milliseconds" << endl;
+        cout << "Throughput: " << NUM_QUERIES * 1000.0 / time_diff.count() << " queries per second" << endl;
+        cout << "Number of batches: " << stats.batch_sizes.size() << endl;
+        cout << "Number of batches of each size (0 ~ " << max_batch_size << "): " << endl;
+        print_vector(batch_size_counts, batch_size_counts.size());
+        cout << "Queue depth after forming a batch, average: " << avg_queue_depth << ", maximum: " << max_queue_depth << endl;
+        cout << "Latency p50: " << percentile(stats.latencies, 0.5) / 1000 << " ms, p90: "
+             << percentile(stats.latencies, 0.9) / 1000 << " ms, p99: " << percentile(stats.latencies, 0.99) / 1000 << " ms" << endl;
+        cout << "All deviations are within the tolerance: " << boolalpha << all_within_tol << endl;
+    }
+    cout << endl;
+}
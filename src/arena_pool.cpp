@@ -0,0 +1,169 @@
+#include "native/examples/examples.h"
+#include "arena_pool.h"
+#include <sys/mman.h>
+
+using namespace std;
+using namespace seal;
+
+static const size_t HUGE_PAGE_SIZE = size_t(1) << 21;
+static const size_t ARENA_ALIGNMENT = 64;
+
+string arena_backing_name(arena_backing backing)
+{
+    switch (backing)
+    {
+    case arena_backing::huge_tlb:
+        return "2 MB huge pages";
+    case arena_backing::transparent_huge:
+        return "transparent huge pages";
+    case arena_backing::regular:
+        return "regular pages";
+    }
+    return "unknown";
+}
+
+/* Hands out items of one size, reusing the items that were given back */
+class ArenaPoolHead : public util::MemoryPoolHead
+{
+public:
+    ArenaPoolHead(ArenaMemoryPool &pool, size_t item_byte_count) : pool_(pool), item_byte_count_(item_byte_count)
+    {}
+
+    size_t item_byte_count() const noexcept override
+    {
+        return item_byte_count_;
+    }
+
+    size_t item_count() const noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    util::MemoryPoolItem *get() override
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (first_)
+        {
+            util::MemoryPoolItem *item = first_;
+            first_ = item->next();
+            item->next() = nullptr;
+            return item;
+        }
+        items_.push_back(make_unique<util::MemoryPoolItem>(pool_.carve(item_byte_count_)));
+        return items_.back().get();
+    }
+
+    void add(util::MemoryPoolItem *new_first) noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        new_first->next() = first_;
+        first_ = new_first;
+    }
+
+private:
+    ArenaMemoryPool &pool_;
+    size_t item_byte_count_;
+    mutable mutex mutex_;
+    vector<unique_ptr<util::MemoryPoolItem>> items_;
+    util::MemoryPoolItem *first_ = nullptr;
+};
+
+ArenaMemoryPool::ArenaMemoryPool(size_t capacity_bytes)
+{
+    capacity_bytes_ = (capacity_bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if (capacity_bytes_ == 0)
+    {
+        return;
+    }
+
+    /* Prefer explicit huge pages, which only exist if the administrator reserved some */
+    void *arena = mmap(nullptr, capacity_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (arena != MAP_FAILED)
+    {
+        backing_ = arena_backing::huge_tlb;
+    }
+    else
+    {
+        arena = mmap(nullptr, capacity_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (arena == MAP_FAILED)
+        {
+            throw bad_alloc();
+        }
+        backing_ = madvise(arena, capacity_bytes_, MADV_HUGEPAGE) == 0 ? arena_backing::transparent_huge : arena_backing::regular;
+    }
+    arena_ = static_cast<seal_byte *>(arena);
+}
+
+ArenaMemoryPool::~ArenaMemoryPool() noexcept
+{
+    heads_.clear();
+    if (arena_)
+    {
+        munmap(arena_, capacity_bytes_);
+    }
+}
+
+util::Pointer<seal_byte> ArenaMemoryPool::get_for_byte_count(size_t byte_count)
+{
+    if (byte_count == 0)
+    {
+        return util::Pointer<seal_byte>();
+    }
+
+    ArenaPoolHead *head;
+    {
+        lock_guard<mutex> lock(mutex_);
+        unique_ptr<ArenaPoolHead> &slot = heads_[byte_count];
+        if (!slot)
+        {
+            slot = make_unique<ArenaPoolHead>(*this, byte_count);
+        }
+        head = slot.get();
+    }
+    return util::Pointer<seal_byte>(head);
+}
+
+size_t ArenaMemoryPool::pool_count() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return heads_.size();
+}
+
+size_t ArenaMemoryPool::alloc_byte_count() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return min(used_bytes_.load(), capacity_bytes_) + overflow_byte_count_;
+}
+
+arena_backing ArenaMemoryPool::backing() const
+{
+    return backing_;
+}
+
+size_t ArenaMemoryPool::capacity_bytes() const
+{
+    return capacity_bytes_;
+}
+
+size_t ArenaMemoryPool::overflow_byte_count() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return overflow_byte_count_;
+}
+
+seal_byte *ArenaMemoryPool::carve(size_t byte_count)
+{
+    size_t aligned_count = (byte_count + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+    size_t offset = used_bytes_.fetch_add(aligned_count);
+    if (offset + aligned_count <= capacity_bytes_)
+    {
+        return arena_ + offset;
+    }
+
+    /* The arena is full */
+    lock_guard<mutex> lock(mutex_);
+    overflow_.push_back(make_unique<seal_byte[]>(byte_count));
+    overflow_byte_count_ += byte_count;
+    return overflow_.back().get();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <atomic>
+#include <map>
+
+using namespace std;
+using namespace seal;
+
+enum class arena_backing
+{
+    huge_tlb,          // Explicit 2 MB huge pages (MAP_HUGETLB)
+    transparent_huge,  // Regular mapping with MADV_HUGEPAGE
+    regular            // Regular pages
+};
+
+string arena_backing_name(arena_backing backing);
+
+class ArenaPoolHead;
+
+/*
+A SEAL memory pool that carves all of its allocations out of one
+contiguous arena, so that the coefficient data of the ciphertexts allocated
+from it is packed next to each other instead of scattered across the heap.
+The arena is mapped with explicit 2 MB huge pages when the system has them
+reserved, with transparent huge pages otherwise, and with regular pages as
+a last resort. Allocations that do not fit in the arena fall back to the
+heap.
+
+Like SEAL's own pools, freed allocations are kept for reuse by later
+allocations of the same size, and the memory is only returned when the pool
+is destroyed. Plug it into SEAL as
+    MemoryPoolHandle pool(make_shared<ArenaMemoryPool>(capacity_bytes));
+Ciphertexts and plaintexts allocated from the pool hold a reference to it.
+*/
+class ArenaMemoryPool : public util::MemoryPool
+{
+public:
+    ArenaMemoryPool(size_t capacity_bytes);
+
+    ~ArenaMemoryPool() noexcept override;
+
+    util::Pointer<seal_byte> get_for_byte_count(size_t byte_count) override;
+
+    size_t pool_count() const override;
+
+    size_t alloc_byte_count() const override;
+
+    arena_backing backing() const;
+
+    size_t capacity_bytes() const;
+
+    /* Bytes that did not fit in the arena and came from the heap */
+    size_t overflow_byte_count() const;
+
+    /* Used by the pool heads to get memory for new items */
+    seal_byte *carve(size_t byte_count);
+
+private:
+    seal_byte *arena_ = nullptr;
+    size_t capacity_bytes_ = 0;
+    arena_backing backing_ = arena_backing::regular;
+    atomic<size_t> used_bytes_{ 0 };
+
+    mutable mutex mutex_;
+    map<size_t, unique_ptr<ArenaPoolHead>> heads_;
+    vector<unique_ptr<seal_byte[]>> overflow_;
+    size_t overflow_byte_count_ = 0;
+};
@@ -0,0 +1,130 @@
+#include "native/examples/examples.h"
+#include "batch_scheduler.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+BatchScheduler::BatchScheduler(
+    SEALContext &context, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    vector<Ciphertext> &encrypted_matrix, size_t dimension,
+    chrono::microseconds batch_window, size_t max_batch_size
+)
+    : evaluator_(context), relin_keys_(relin_keys), galois_keys_(galois_keys), encrypted_matrix_(encrypted_matrix),
+      dimension_(dimension), batch_window_(batch_window), max_batch_size_(max(max_batch_size, size_t(1)))
+{
+    check_dimension(context, dimension);
+    worker_ = thread(&BatchScheduler::run, this);
+}
+
+BatchScheduler::~BatchScheduler()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queue_changed_.notify_all();
+    worker_.join();
+}
+
+future<vector<Ciphertext>> BatchScheduler::submit(Ciphertext encrypted_vector)
+{
+    PendingQuery query;
+    query.encrypted_vector = move(encrypted_vector);
+    query.submitted = chrono::steady_clock::now();
+    future<vector<Ciphertext>> result = query.result.get_future();
+    {
+        lock_guard<mutex> lock(mutex_);
+        queue_.push_back(move(query));
+    }
+    queue_changed_.notify_one();
+    return result;
+}
+
+size_t BatchScheduler::queue_depth()
+{
+    lock_guard<mutex> lock(mutex_);
+    return queue_.size();
+}
+
+SchedulerStats BatchScheduler::stats()
+{
+    lock_guard<mutex> lock(mutex_);
+    return stats_;
+}
+
+void BatchScheduler::run()
+{
+    while (true)
+    {
+        vector<PendingQuery> batch;
+        {
+            unique_lock<mutex> lock(mutex_);
+            queue_changed_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+            if (queue_.empty())
+            {
+                return;
+            }
+
+            /* Wait for the window of the oldest query to close or for a full batch */
+            auto deadline = queue_.front().submitted + batch_window_;
+            queue_changed_.wait_until(lock, deadline, [this]() { return stopping_ || queue_.size() >= max_batch_size_; });
+
+            size_t batch_size = min(queue_.size(), max_batch_size_);
+            for (size_t i = 0; i < batch_size; i++)
+            {
+                batch.push_back(move(queue_.front()));
+                queue_.pop_front();
+            }
+            stats_.batch_sizes.push_back(batch_size);
+            stats_.queue_depths.push_back(queue_.size());
+        }
+
+        evaluate_batch(batch);
+    }
+}
+
+void BatchScheduler::evaluate_batch(vector<PendingQuery> &batch)
+{
+    vector<vector<Ciphertext>> product_vectors;
+    exception_ptr error;
+    try
+    {
+        /* One pass over the rows for the whole batch */
+        product_vectors.assign(batch.size(), vector<Ciphertext>(encrypted_matrix_.size()));
+        DotProductEngine<CKKSScheme> engine(evaluator_, relin_keys_, galois_keys_, dimension_);
+        for (size_t i = 0; i < encrypted_matrix_.size(); i++)
+        {
+            for (size_t q = 0; q < batch.size(); q++)
+            {
+                product_vectors[q][i] = engine.dot_product(encrypted_matrix_[i], batch[q].encrypted_vector);
+            }
+        }
+    }
+    catch (...)
+    {
+        error = current_exception();
+    }
+
+    /* Record the latencies before any future is ready, so that stats() already includes this batch */
+    auto completed = chrono::steady_clock::now();
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (size_t q = 0; q < batch.size(); q++)
+        {
+            stats_.latencies.push_back(chrono::duration_cast<chrono::microseconds>(completed - batch[q].submitted).count());
+        }
+    }
+
+    for (size_t q = 0; q < batch.size(); q++)
+    {
+        if (error)
+        {
+            batch[q].result.set_exception(error);
+        }
+        else
+        {
+            batch[q].result.set_value(move(product_vectors[q]));
+        }
+    }
+}
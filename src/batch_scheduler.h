@@ -0,0 +1,71 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <condition_variable>
+#include <deque>
+#include <future>
+
+using namespace std;
+using namespace seal;
+
+/* What the scheduler observed, one entry per batch or per query */
+struct SchedulerStats
+{
+    vector<size_t> batch_sizes;
+    vector<size_t> queue_depths;   // Queries still waiting when each batch was formed
+    vector<int64_t> latencies;     // Submission to completion, in microseconds
+};
+
+/*
+Queues encrypted queries that arrive independently and evaluates them in
+batches on a background thread. A batch is formed once the oldest waiting
+query has waited batch_window, or as soon as max_batch_size queries are
+waiting. Each batch makes a single pass over the rows, multiplying every
+row with every query of the batch while the row is hot in cache, and then
+completes the future of each query with its own result ciphertexts.
+*/
+class BatchScheduler
+{
+public:
+    BatchScheduler(
+        SEALContext &context, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+        vector<Ciphertext> &encrypted_matrix, size_t dimension,
+        chrono::microseconds batch_window, size_t max_batch_size
+    );
+
+    /* Finishes the queries already submitted and stops the background thread */
+    ~BatchScheduler();
+
+    future<vector<Ciphertext>> submit(Ciphertext encrypted_vector);
+
+    size_t queue_depth();
+
+    SchedulerStats stats();
+
+private:
+    struct PendingQuery
+    {
+        Ciphertext encrypted_vector;
+        promise<vector<Ciphertext>> result;
+        chrono::steady_clock::time_point submitted;
+    };
+
+    void run();
+
+    void evaluate_batch(vector<PendingQuery> &batch);
+
+    Evaluator evaluator_;
+    RelinKeys &relin_keys_;
+    GaloisKeys &galois_keys_;
+    vector<Ciphertext> &encrypted_matrix_;
+    size_t dimension_;
+    chrono::microseconds batch_window_;
+    size_t max_batch_size_;
+
+    mutex mutex_;
+    condition_variable queue_changed_;
+    deque<PendingQuery> queue_;
+    bool stopping_ = false;
+    SchedulerStats stats_;
+    thread worker_;
+};
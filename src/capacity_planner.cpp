@@ -0,0 +1,173 @@
+#include "native/examples/examples.h"
+#include "capacity_planner.h"
+#include "my_utils.h"
+#include "query_service.h"
+
+using namespace std;
+using namespace seal;
+
+static double median(vector<double> values)
+{
+    sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+CapacityPlanner::CapacityPlanner(
+    SEALContext &context, double scale, size_t dimension, vector<size_t> thread_counts,
+    size_t calibration_rows, size_t calibration_reps
+)
+    : dimension_(dimension), compr_mode_(best_compr_mode()), thread_counts_(thread_counts)
+{
+    check_dimension(context, dimension);
+    auto calibration_start = chrono::high_resolution_clock::now();
+    calibration_reps = max<size_t>(calibration_reps, 1);
+
+    /* Setting up keys and object instances */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+    CKKSEncoder encoder(context);
+
+    size_t slot_count = encoder.slot_count();
+    vecs_per_row_ = slot_count / dimension;
+    public_key_bytes_ = static_cast<size_t>(public_key.save_size(compr_mode_));
+    relin_keys_bytes_ = static_cast<size_t>(relin_keys.save_size(compr_mode_));
+    galois_keys_bytes_ = static_cast<size_t>(galois_keys.save_size(compr_mode_));
+
+    /* Random rows, since the cost does not depend on the values */
+    mt19937 gen(0);
+    uniform_real_distribution<double> unif(0, 1);
+    vector<vector<double>> matrix(calibration_rows, vector<double>(slot_count));
+    for (auto &row : matrix)
+    {
+        for (double &value : row)
+        {
+            value = unif(gen);
+        }
+    }
+    vector<Ciphertext> encrypted_matrix(calibration_rows);
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix);
+
+    Ciphertext &sample = encrypted_matrix[0];
+    ciphertext_bytes_ = sample.size() * sample.poly_modulus_degree() * sample.coeff_modulus_size() * sizeof(uint64_t);
+    stringstream stream;
+    serialized_bytes_ = static_cast<size_t>(sample.save(stream, compr_mode_));
+
+    /* Preparing the query */
+    vector<double> duplicated_vec(slot_count);
+    for (size_t i = 0; i < slot_count; i++)
+    {
+        duplicated_vec[i] = matrix[0][i % dimension];
+    }
+    vector<double> query_samples(calibration_reps);
+    PreparedQuery query;
+    for (size_t rep = 0; rep < calibration_reps; rep++)
+    {
+        auto time_start = chrono::high_resolution_clock::now();
+        Plaintext plain_vector;
+        encoder.encode(duplicated_vec, scale, plain_vector);
+        Ciphertext encrypted_vector;
+        encryptor.encrypt(plain_vector, encrypted_vector);
+        query = prepare_query(context, evaluator, encrypted_vector, sample.parms_id());
+        auto time_end = chrono::high_resolution_clock::now();
+        query_samples[rep] = chrono::duration<double, micro>(time_end - time_start).count();
+    }
+    query_us_ = median(query_samples);
+
+    /* Per-row scan time with every thread busy */
+    for (size_t num_threads : thread_counts_)
+    {
+        vector<Ciphertext> replicated;
+        for (size_t t = 0; t < num_threads; t++)
+        {
+            replicated.insert(replicated.end(), encrypted_matrix.begin(), encrypted_matrix.end());
+        }
+        vector<Ciphertext> product_vector =
+            parallel_CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, replicated, query, dimension, num_threads);
+
+        vector<double> samples(calibration_reps);
+        for (size_t rep = 0; rep < calibration_reps; rep++)
+        {
+            auto time_start = chrono::high_resolution_clock::now();
+            product_vector =
+                parallel_CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, replicated, query, dimension, num_threads);
+            auto time_end = chrono::high_resolution_clock::now();
+            samples[rep] = chrono::duration<double, micro>(time_end - time_start).count() / calibration_rows;
+        }
+        row_us_.push_back(samples);
+    }
+
+    /* Decrypting and decoding one result */
+    vector<Ciphertext> product_vector = CKKS_matrix_vector_product(evaluator, relin_keys, galois_keys, encrypted_matrix, query, dimension);
+    vector<double> decrypt_samples(calibration_reps);
+    for (size_t rep = 0; rep < calibration_reps; rep++)
+    {
+        auto time_start = chrono::high_resolution_clock::now();
+        packed_CKKS_result(decryptor, encoder, product_vector[rep % product_vector.size()], dimension);
+        auto time_end = chrono::high_resolution_clock::now();
+        decrypt_samples[rep] = chrono::duration<double, micro>(time_end - time_start).count();
+    }
+    decrypt_us_ = median(decrypt_samples);
+
+    auto calibration_end = chrono::high_resolution_clock::now();
+    calibration_ms_ = chrono::duration_cast<chrono::milliseconds>(calibration_end - calibration_start).count();
+}
+
+CapacityPlan CapacityPlanner::plan(size_t num_embeddings) const
+{
+    CapacityPlan plan;
+    plan.num_embeddings = num_embeddings;
+    plan.dimension = dimension_;
+    plan.vecs_per_row = vecs_per_row_;
+    plan.num_ciphertexts = (num_embeddings + vecs_per_row_ - 1) / vecs_per_row_;
+    plan.memory_bytes = plan.num_ciphertexts * ciphertext_bytes_;
+    plan.disk_bytes = plan.num_ciphertexts * serialized_bytes_;
+    plan.compr_mode = compr_mode_;
+    plan.public_key_bytes = public_key_bytes_;
+    plan.relin_keys_bytes = relin_keys_bytes_;
+    plan.galois_keys_bytes = galois_keys_bytes_;
+    plan.thread_counts = thread_counts_;
+
+    for (size_t i = 0; i < thread_counts_.size(); i++)
+    {
+        size_t rows_per_thread = (plan.num_ciphertexts + thread_counts_[i] - 1) / thread_counts_[i];
+        vector<int64_t> latencies;
+        for (double row_us : row_us_[i])
+        {
+            latencies.push_back(static_cast<int64_t>(query_us_ + rows_per_thread * row_us + plan.num_ciphertexts * decrypt_us_));
+        }
+        plan.p50_ms.push_back(percentile(latencies, 0.5) / 1000.0);
+        plan.p99_ms.push_back(percentile(latencies, 0.99) / 1000.0);
+    }
+    return plan;
+}
+
+int64_t CapacityPlanner::calibration_ms() const
+{
+    return calibration_ms_;
+}
+
+void print_capacity_plan(const CapacityPlan &plan)
+{
+    const double MB = 1 << 20;
+    cout << "Embeddings: " << plan.num_embeddings << " of dimension " << plan.dimension << ", " << plan.vecs_per_row
+         << " per ciphertext" << endl;
+    cout << "Ciphertexts: " << plan.num_ciphertexts << endl;
+    cout << "Rows in memory: " << plan.memory_bytes / MB << " MB, on disk: " << plan.disk_bytes / MB << " MB"
+         << (plan.compr_mode == compr_mode_type::none ? "" : " (compressed)") << endl;
+    cout << "Public key: " << plan.public_key_bytes / MB << " MB, relinearization keys: " << plan.relin_keys_bytes / MB
+         << " MB, Galois keys: " << plan.galois_keys_bytes / MB << " MB" << endl;
+    for (size_t i = 0; i < plan.thread_counts.size(); i++)
+    {
+        cout << "Threads: " << plan.thread_counts[i] << ", latency p50: " << plan.p50_ms[i] << " ms, p99: " << plan.p99_ms[i]
+             << " ms" << endl;
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "native/examples/examples.h"
+
+using namespace std;
+using namespace seal;
+
+/* Predicted resources for one corpus size */
+struct CapacityPlan
+{
+    size_t num_embeddings = 0;
+    size_t dimension = 0;
+    size_t vecs_per_row = 0;
+    size_t num_ciphertexts = 0;
+    size_t memory_bytes = 0;        // Coefficient data of all rows
+    size_t disk_bytes = 0;          // All rows serialized with compr_mode
+    compr_mode_type compr_mode = compr_mode_type::none;
+    size_t public_key_bytes = 0;
+    size_t relin_keys_bytes = 0;
+    size_t galois_keys_bytes = 0;
+    vector<size_t> thread_counts;
+    vector<double> p50_ms;          // Per thread count, from encrypting the query to decoding the results
+    vector<double> p99_ms;
+};
+
+/*
+Calibrates the cost of a query for one parameter set and dimension on a few
+packed rows, and extrapolates it to any number of embeddings. Sizes come
+from real ciphertexts and keys. For each thread count, every thread scans
+calibration_rows rows at once, so that contention for memory bandwidth is
+part of the per-row time. A scan of R rows on T threads is predicted to
+take ceil(R / T) of those per-row times, plus preparing the query and
+decrypting the R results, and the percentiles are taken over the
+calibration repetitions.
+*/
+class CapacityPlanner
+{
+public:
+    CapacityPlanner(
+        SEALContext &context, double scale, size_t dimension, vector<size_t> thread_counts,
+        size_t calibration_rows = 8, size_t calibration_reps = 20
+    );
+
+    CapacityPlan plan(size_t num_embeddings) const;
+
+    /* Time spent calibrating, in milliseconds */
+    int64_t calibration_ms() const;
+
+private:
+    size_t dimension_;
+    size_t vecs_per_row_;
+    size_t ciphertext_bytes_ = 0;
+    size_t serialized_bytes_ = 0;
+    compr_mode_type compr_mode_;
+    size_t public_key_bytes_ = 0;
+    size_t relin_keys_bytes_ = 0;
+    size_t galois_keys_bytes_ = 0;
+    vector<size_t> thread_counts_;
+    vector<vector<double>> row_us_;   // Per thread count, per repetition
+    double query_us_ = 0;
+    double decrypt_us_ = 0;
+    int64_t calibration_ms_ = 0;
+};
+
+void print_capacity_plan(const CapacityPlan &plan);
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <array>
+#include <type_traits>
+
+using namespace std;
+using namespace seal;
+
+/* Scheme tags for DotProductEngine */
+struct BFVScheme
+{};
+
+struct CKKSScheme
+{};
+
+/* Selects the dimension at construction instead of at compile time */
+constexpr size_t RUNTIME_DIMENSION = 0;
+
+constexpr bool is_power_of_two(size_t n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+/*
+Throws unless the dimension is a power of two that fits in one row of slots,
+which is N / 2 for both schemes. Classes that take a dimension check it in
+their constructors, so that a bad one fails there and not on the first query.
+*/
+inline void check_dimension(const SEALContext &context, size_t dimension)
+{
+    if (!is_power_of_two(dimension) || dimension > context.first_context_data()->parms().poly_modulus_degree() / 2)
+    {
+        throw invalid_argument("dimension must be a power of two no larger than the number of slots");
+    }
+}
+
+constexpr size_t log2_of(size_t n)
+{
+    return n <= 1 ? 0 : 1 + log2_of(n / 2);
+}
+
+/* Rotation steps dimension / 2, dimension / 4, ..., 1 */
+template <size_t Dimension>
+constexpr array<int, log2_of(Dimension)> rotation_schedule()
+{
+    array<int, log2_of(Dimension)> steps{};
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        steps[i] = static_cast<int>(Dimension >> (i + 1));
+    }
+    return steps;
+}
+
+/* Galois element SEAL uses for a left rotation by step: 3^step mod 2N */
+constexpr uint32_t galois_element(int step, size_t poly_modulus_degree)
+{
+    uint64_t m = 2 * poly_modulus_degree;
+    uint64_t element = 1;
+    for (int i = 0; i < step; i++)
+    {
+        element = element * 3 % m;
+    }
+    return static_cast<uint32_t>(element);
+}
+
+template <size_t Dimension, size_t PolyModulusDegree>
+constexpr array<uint32_t, log2_of(Dimension)> rotation_galois_elements()
+{
+    array<int, log2_of(Dimension)> steps = rotation_schedule<Dimension>();
+    array<uint32_t, log2_of(Dimension)> elements{};
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        elements[i] = galois_element(steps[i], PolyModulusDegree);
+    }
+    return elements;
+}
+
+static_assert(galois_element(1, 8192) == 3 && galois_element(2, 8192) == 9, "SEAL rotates with powers of 3");
+static_assert(rotation_galois_elements<4, 8192>()[0] == 9 && rotation_galois_elements<4, 8192>()[1] == 3, "");
+
+/*
+The packed dot product of Tests 1 to 5 for either scheme: multiply,
+relinearize, rescale for CKKS only, then rotate and add log2(dimension)
+times. With a compile-time Dimension the rotation schedule is a constexpr
+array that the compiler unrolls; with RUNTIME_DIMENSION it is built once in
+the constructor. The rotated scratch ciphertext is a member, reserved at the
+level the rotations run at when a context is given and allocated on first
+use otherwise, so an engine must only be used by one thread at a time. Build
+one engine per scan or per thread, with that thread's memory pool, rather
+than one per row. BFV_dot_product and CKKS_dot_product are wrappers over a
+runtime engine for a single product.
+
+Only the Galois keys returned by galois_elements are needed, instead of
+every power of two.
+*/
+template <class Scheme, size_t Dimension = RUNTIME_DIMENSION>
+class DotProductEngine
+{
+    static_assert(is_same<Scheme, BFVScheme>::value || is_same<Scheme, CKKSScheme>::value, "unknown scheme");
+    static_assert(Dimension == RUNTIME_DIMENSION || is_power_of_two(Dimension), "dimension must be a power of two");
+
+public:
+    static constexpr bool is_ckks = is_same<Scheme, CKKSScheme>::value;
+
+    DotProductEngine(
+        Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, size_t dimension = Dimension,
+        MemoryPoolHandle pool = MemoryManager::GetPool()
+    )
+        : evaluator_(evaluator), relin_keys_(relin_keys), galois_keys_(galois_keys), dimension_(dimension), pool_(pool),
+          product_rotated_(pool)
+    {
+        if (!is_power_of_two(dimension_) || (Dimension != RUNTIME_DIMENSION && dimension_ != Dimension))
+        {
+            throw invalid_argument("dimension must be a power of two matching the template argument");
+        }
+        if (Dimension == RUNTIME_DIMENSION)
+        {
+            for (size_t step = dimension_ / 2; step >= 1; step /= 2)
+            {
+                runtime_steps_.push_back(static_cast<int>(step));
+            }
+        }
+    }
+
+    DotProductEngine(
+        SEALContext &context, Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+        size_t dimension = Dimension, MemoryPoolHandle pool = MemoryManager::GetPool()
+    )
+        : DotProductEngine(evaluator, relin_keys, galois_keys, dimension, pool)
+    {
+        /* CKKS rotates after the rescale, one level below the rows */
+        auto context_data = context.first_context_data();
+        if (is_ckks && context_data->next_context_data())
+        {
+            context_data = context_data->next_context_data();
+        }
+        product_rotated_.reserve(context, context_data->parms_id(), 2);
+    }
+
+    size_t dimension() const
+    {
+        return dimension_;
+    }
+
+    /* The Galois elements of the rotation schedule, for KeyGenerator::create_galois_keys */
+    vector<uint32_t> galois_elements(size_t poly_modulus_degree) const
+    {
+        vector<uint32_t> elements;
+        for (size_t step = dimension_ / 2; step >= 1; step /= 2)
+        {
+            elements.push_back(galois_element(static_cast<int>(step), poly_modulus_degree));
+        }
+        return elements;
+    }
+
+    void dot_product(const Ciphertext &encrypted1, const Ciphertext &encrypted2, Ciphertext &destination)
+    {
+        evaluator_.multiply(encrypted1, encrypted2, destination, pool_);
+        evaluator_.relinearize_inplace(destination, relin_keys_, pool_);
+        if constexpr (is_ckks)
+        {
+            evaluator_.rescale_to_next_inplace(destination, pool_);
+        }
+        rotation_reduction(destination);
+    }
+
+    /* A product with a plaintext query, which needs no relinearization */
+    void dot_product(const Ciphertext &encrypted, const Plaintext &plain, Ciphertext &destination)
+    {
+        evaluator_.multiply_plain(encrypted, plain, destination, pool_);
+        if constexpr (is_ckks)
+        {
+            evaluator_.rescale_to_next_inplace(destination, pool_);
+        }
+        rotation_reduction(destination);
+    }
+
+    /* Rotates and adds log2(dimension) times, which sums each group of dimension slots */
+    void rotation_reduction(Ciphertext &product)
+    {
+        if constexpr (Dimension != RUNTIME_DIMENSION)
+        {
+            constexpr array<int, log2_of(Dimension)> steps = rotation_schedule<Dimension>();
+            for (int step : steps)
+            {
+                rotate_and_add(product, step);
+            }
+        }
+        else
+        {
+            for (int step : runtime_steps_)
+            {
+                rotate_and_add(product, step);
+            }
+        }
+    }
+
+    Ciphertext dot_product(const Ciphertext &encrypted1, const Ciphertext &encrypted2)
+    {
+        Ciphertext product(pool_);
+        dot_product(encrypted1, encrypted2, product);
+        return product;
+    }
+
+    Ciphertext dot_product(const Ciphertext &encrypted, const Plaintext &plain)
+    {
+        Ciphertext product(pool_);
+        dot_product(encrypted, plain, product);
+        return product;
+    }
+
+    vector<Ciphertext> matrix_vector_product(vector<Ciphertext> &encrypted_matrix, const Ciphertext &encrypted_vector)
+    {
+        vector<Ciphertext> product_vector(encrypted_matrix.size(), Ciphertext(pool_));
+        for (size_t i = 0; i < encrypted_matrix.size(); i++)
+        {
+            dot_product(encrypted_matrix[i], encrypted_vector, product_vector[i]);
+        }
+        return product_vector;
+    }
+
+private:
+    void rotate_and_add(Ciphertext &product, int step)
+    {
+        if constexpr (is_ckks)
+        {
+            evaluator_.rotate_vector(product, step, galois_keys_, product_rotated_, pool_);
+        }
+        else
+        {
+            evaluator_.rotate_rows(product, step, galois_keys_, product_rotated_, pool_);
+        }
+        evaluator_.add_inplace(product, product_rotated_);
+    }
+
+    Evaluator &evaluator_;
+    RelinKeys &relin_keys_;
+    GaloisKeys &galois_keys_;
+    size_t dimension_;
+    MemoryPoolHandle pool_;
+    vector<int> runtime_steps_;
+    Ciphertext product_rotated_;
+};
@@ -0,0 +1,326 @@
+#include "native/examples/examples.h"
+#include "encrypted_index.h"
+#include "my_utils.h"
+#include <map>
+
+using namespace std;
+using namespace seal;
+
+EncryptedIndex::EncryptedIndex(SEALContext &context, PublicKey &public_key, double scale, size_t dimension)
+    : encryptor_(context, public_key), evaluator_(context), encoder_(context), scale_(scale), dimension_(dimension)
+{
+    check_dimension(context, dimension_);
+    slot_count_ = encoder_.slot_count();
+    blocks_per_row_ = slot_count_ / dimension_;
+}
+
+EncryptedIndex::~EncryptedIndex()
+{
+    wait_for_compaction();
+}
+
+size_t EncryptedIndex::insert(vector<double> &embedding, const BlockAttributes &attributes)
+{
+    if (embedding.size() != dimension_)
+    {
+        throw invalid_argument("embedding has the wrong dimension");
+    }
+
+    unique_lock<mutex> lock(mutex_);
+    size_t block_id;
+    if (!free_blocks_.empty())
+    {
+        /* Reuse a free block of a live row */
+        block_id = free_blocks_.back();
+        free_blocks_.pop_back();
+        block_used_[block_id] = true;
+        block_attributes_[block_id] = attributes;
+        row_used_count_[block_id / blocks_per_row_]++;
+        num_used_blocks_++;
+        lock.unlock();
+
+        add_masked_delta(block_id, embedding);
+        return block_id;
+    }
+
+    /* Otherwise bring back a released row, or append a new one */
+    size_t row_num;
+    if (!released_rows_.empty())
+    {
+        row_num = released_rows_.back();
+        released_rows_.pop_back();
+        row_released_[row_num] = false;
+    }
+    else
+    {
+        row_num = rows_.size();
+        rows_.emplace_back();
+        row_used_count_.push_back(0);
+        row_released_.push_back(false);
+        block_used_.resize(block_used_.size() + blocks_per_row_, false);
+        block_attributes_.resize(block_used_.size());
+    }
+
+    /* The new row is a fresh encryption of the embedding in its first block */
+    block_id = row_num * blocks_per_row_;
+    encrypt_masked_delta(block_id, embedding, rows_[row_num]);
+    block_used_[block_id] = true;
+    block_attributes_[block_id] = attributes;
+    row_used_count_[row_num] = 1;
+    num_used_blocks_++;
+    for (size_t j = blocks_per_row_ - 1; j >= 1; j--)
+    {
+        free_blocks_.push_back(block_id + j);
+    }
+    return block_id;
+}
+
+void EncryptedIndex::update(size_t block_id, vector<double> &old_embedding, vector<double> &new_embedding)
+{
+    if (old_embedding.size() != dimension_ || new_embedding.size() != dimension_)
+    {
+        throw invalid_argument("embedding has the wrong dimension");
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (block_id >= block_used_.size() || !block_used_[block_id])
+        {
+            throw invalid_argument("block is not in use");
+        }
+    }
+
+    vector<double> delta(dimension_);
+    for (size_t i = 0; i < dimension_; i++)
+    {
+        delta[i] = new_embedding[i] - old_embedding[i];
+    }
+    add_masked_delta(block_id, delta);
+}
+
+void EncryptedIndex::remove(size_t block_id, vector<double> &old_embedding)
+{
+    if (old_embedding.size() != dimension_)
+    {
+        throw invalid_argument("embedding has the wrong dimension");
+    }
+    {
+        /* Claim the block first, so that a concurrent remove of the same block fails */
+        lock_guard<mutex> lock(mutex_);
+        if (block_id >= block_used_.size() || !block_used_[block_id])
+        {
+            throw invalid_argument("block is not in use");
+        }
+        block_used_[block_id] = false;
+        block_attributes_[block_id] = BlockAttributes();
+    }
+
+    vector<double> delta(dimension_);
+    for (size_t i = 0; i < dimension_; i++)
+    {
+        delta[i] = -old_embedding[i];
+    }
+    add_masked_delta(block_id, delta);
+
+    /* The row only counts as empty, and the block as free, once the delta is in */
+    lock_guard<mutex> lock(mutex_);
+    row_used_count_[block_id / blocks_per_row_]--;
+    num_used_blocks_--;
+    free_blocks_.push_back(block_id);
+}
+
+void EncryptedIndex::start_compaction()
+{
+    wait_for_compaction();
+    compaction_thread_ = thread(&EncryptedIndex::compact, this);
+}
+
+void EncryptedIndex::wait_for_compaction()
+{
+    if (compaction_thread_.joinable())
+    {
+        compaction_thread_.join();
+    }
+}
+
+vector<Ciphertext> EncryptedIndex::matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    Ciphertext &encrypted_vector, vector<size_t> &row_ids
+)
+{
+    lock_guard<mutex> lock(mutex_);
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension_);
+    vector<Ciphertext> product_vector;
+    row_ids.clear();
+    for (size_t row_num = 0; row_num < rows_.size(); row_num++)
+    {
+        if (row_released_[row_num])
+        {
+            continue;
+        }
+        product_vector.push_back(engine.dot_product(rows_[row_num], encrypted_vector));
+        row_ids.push_back(row_num);
+    }
+    return product_vector;
+}
+
+vector<Ciphertext> EncryptedIndex::filtered_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    Ciphertext &encrypted_vector, const function<bool(const BlockAttributes &)> &filter,
+    vector<size_t> &row_ids
+)
+{
+    lock_guard<mutex> lock(mutex_);
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension_);
+    vector<Ciphertext> product_vector;
+    row_ids.clear();
+
+    /* Rows with the same matching blocks share one mask */
+    map<vector<bool>, Plaintext> masks;
+    vector<bool> matches(blocks_per_row_);
+    for (size_t row_num = 0; row_num < rows_.size(); row_num++)
+    {
+        if (row_released_[row_num] || row_used_count_[row_num] == 0)
+        {
+            continue;
+        }
+
+        size_t num_matches = 0;
+        for (size_t j = 0; j < blocks_per_row_; j++)
+        {
+            size_t block_id = row_num * blocks_per_row_ + j;
+            matches[j] = block_used_[block_id] && filter(block_attributes_[block_id]);
+            num_matches += matches[j];
+        }
+        if (num_matches == 0)
+        {
+            continue;
+        }
+
+        Ciphertext product = engine.dot_product(rows_[row_num], encrypted_vector);
+        if (num_matches < blocks_per_row_)
+        {
+            auto mask = masks.find(matches);
+            if (mask == masks.end())
+            {
+                vector<double> mask_vec(slot_count_, 0ULL);
+                for (size_t j = 0; j < blocks_per_row_; j++)
+                {
+                    mask_vec[j * dimension_] = matches[j] ? 1 : 0;
+                }
+                Plaintext plain_mask;
+                encoder_.encode(mask_vec, product.parms_id(), scale_, plain_mask);
+                mask = masks.emplace(matches, move(plain_mask)).first;
+            }
+            evaluator.multiply_plain_inplace(product, mask->second);
+            evaluator.rescale_to_next_inplace(product);
+        }
+        product_vector.push_back(move(product));
+        row_ids.push_back(row_num);
+    }
+    return product_vector;
+}
+
+size_t EncryptedIndex::blocks_per_row() const
+{
+    return blocks_per_row_;
+}
+
+size_t EncryptedIndex::num_rows()
+{
+    lock_guard<mutex> lock(mutex_);
+    return rows_.size();
+}
+
+size_t EncryptedIndex::num_live_rows()
+{
+    lock_guard<mutex> lock(mutex_);
+    return rows_.size() - released_rows_.size();
+}
+
+size_t EncryptedIndex::num_used_blocks()
+{
+    lock_guard<mutex> lock(mutex_);
+    return num_used_blocks_;
+}
+
+size_t EncryptedIndex::num_free_blocks()
+{
+    lock_guard<mutex> lock(mutex_);
+    return free_blocks_.size();
+}
+
+void EncryptedIndex::encrypt_masked_delta(size_t block_id, vector<double> &delta, Ciphertext &destination)
+{
+    /* Every slot outside of the block is zero */
+    vector<double> masked_delta(slot_count_, 0ULL);
+    size_t offset = (block_id % blocks_per_row_) * dimension_;
+    for (size_t i = 0; i < dimension_; i++)
+    {
+        masked_delta[offset + i] = delta[i];
+    }
+
+    Plaintext plain_delta;
+    encoder_.encode(masked_delta, scale_, plain_delta);
+    encryptor_.encrypt(plain_delta, destination);
+}
+
+void EncryptedIndex::add_masked_delta(size_t block_id, vector<double> &delta)
+{
+    /* Encrypt outside of the lock so that changes to other rows can proceed */
+    Ciphertext encrypted_delta;
+    encrypt_masked_delta(block_id, delta, encrypted_delta);
+
+    lock_guard<mutex> lock(mutex_);
+    evaluator_.add_inplace(rows_[block_id / blocks_per_row_], encrypted_delta);
+}
+
+void EncryptedIndex::compact()
+{
+    /* Finding the rows without used blocks from a snapshot, so that changes are not blocked */
+    vector<size_t> row_used_count;
+    vector<bool> row_released;
+    {
+        lock_guard<mutex> lock(mutex_);
+        row_used_count = row_used_count_;
+        row_released = row_released_;
+    }
+    vector<size_t> empty_rows;
+    for (size_t row_num = 0; row_num < row_used_count.size(); row_num++)
+    {
+        if (!row_released[row_num] && row_used_count[row_num] == 0)
+        {
+            empty_rows.push_back(row_num);
+        }
+    }
+    if (empty_rows.empty())
+    {
+        return;
+    }
+
+    /* Swapping the empty rows out, keeping any that an insert has used since the snapshot */
+    vector<Ciphertext> released;
+    {
+        lock_guard<mutex> lock(mutex_);
+        for (size_t row_num : empty_rows)
+        {
+            if (row_used_count_[row_num] == 0)
+            {
+                released.emplace_back();
+                swap(released.back(), rows_[row_num]);
+                row_released_[row_num] = true;
+                released_rows_.push_back(row_num);
+            }
+        }
+
+        /* Drop the free blocks of released rows from the free list */
+        free_blocks_.erase(
+            remove_if(
+                free_blocks_.begin(), free_blocks_.end(),
+                [&](size_t block_id) { return row_released_[block_id / blocks_per_row_]; }
+            ),
+            free_blocks_.end()
+        );
+    }
+
+    /* The released ciphertexts are freed here, outside of the lock */
+}
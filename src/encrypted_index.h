@@ -0,0 +1,117 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <functional>
+
+using namespace std;
+using namespace seal;
+
+/* Plaintext metadata stored next to each block, for filtered queries */
+struct BlockAttributes
+{
+    uint32_t tenant = 0;
+    uint32_t language = 0;
+    uint32_t date = 0;     // Days since the epoch
+};
+
+/*
+An encrypted index of packed embeddings that can be changed in place.
+
+Each row ciphertext holds slot_count / dimension blocks, and each block holds
+one embedding. A block is addressed by its block id, which is
+row_num * blocks_per_row + block_num, the same order used by
+packed_CKKS_results. Free blocks always decrypt to zero, so inserting,
+updating and deleting an embedding only require homomorphically adding an
+encrypted delta that is masked to the block (zero in every other slot).
+None of these operations touch any other row, so their latency does not
+depend on the size of the index.
+
+The index does not keep the plaintext embeddings. Updates and deletes take
+the old embedding from the caller (the data owner), which is needed to form
+the delta.
+*/
+class EncryptedIndex
+{
+public:
+    /* Throws unless dimension is a power of two no larger than the number of slots */
+    EncryptedIndex(SEALContext &context, PublicKey &public_key, double scale, size_t dimension);
+
+    ~EncryptedIndex();
+
+    /* Inserts an embedding into a free block and returns its block id */
+    size_t insert(vector<double> &embedding, const BlockAttributes &attributes = BlockAttributes());
+
+    /* Overwrites the embedding in a used block */
+    void update(size_t block_id, vector<double> &old_embedding, vector<double> &new_embedding);
+
+    /* Zeroes a used block and returns it to the free list */
+    void remove(size_t block_id, vector<double> &old_embedding);
+
+    /*
+    Starts releasing the ciphertexts of rows with no used blocks on a
+    background thread. Released rows are skipped by the scan and are
+    re-encrypted when an insert needs them again.
+    */
+    void start_compaction();
+
+    void wait_for_compaction();
+
+    /*
+    Evaluates the packed matrix vector product over every row that has not
+    been released. row_ids receives the row number of each result ciphertext.
+    */
+    vector<Ciphertext> matrix_vector_product(
+        Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+        Ciphertext &encrypted_vector, vector<size_t> &row_ids
+    );
+
+    /*
+    Evaluates the packed matrix vector product only over the rows with at
+    least one used block whose attributes pass the filter. In rows that
+    also hold other blocks, the results are multiplied by a plaintext mask
+    that zeroes every slot except those of the matching blocks, and are
+    rescaled once more.
+    */
+    vector<Ciphertext> filtered_matrix_vector_product(
+        Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+        Ciphertext &encrypted_vector, const function<bool(const BlockAttributes &)> &filter,
+        vector<size_t> &row_ids
+    );
+
+    size_t blocks_per_row() const;
+
+    size_t num_rows();
+
+    size_t num_live_rows();
+
+    size_t num_used_blocks();
+
+    size_t num_free_blocks();
+
+private:
+    void encrypt_masked_delta(size_t block_id, vector<double> &delta, Ciphertext &destination);
+
+    void add_masked_delta(size_t block_id, vector<double> &delta);
+
+    void compact();
+
+    Encryptor encryptor_;
+    Evaluator evaluator_;
+    CKKSEncoder encoder_;
+    double scale_;
+    size_t dimension_;
+    size_t slot_count_;
+    size_t blocks_per_row_;
+
+    vector<Ciphertext> rows_;
+    vector<size_t> row_used_count_;
+    vector<bool> row_released_;
+    vector<bool> block_used_;
+    vector<BlockAttributes> block_attributes_;
+    vector<size_t> free_blocks_;
+    vector<size_t> released_rows_;
+    size_t num_used_blocks_ = 0;
+
+    mutex mutex_;
+    thread compaction_thread_;
+};
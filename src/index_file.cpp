@@ -0,0 +1,339 @@
+#include "native/examples/examples.h"
+#include "index_file.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace seal;
+
+static const uint64_t INDEX_FILE_MAGIC = 0x46584449;   // "IDXF"
+
+static size_t round_up(size_t size)
+{
+    return (size + INDEX_FILE_ALIGNMENT - 1) / INDEX_FILE_ALIGNMENT * INDEX_FILE_ALIGNMENT;
+}
+
+static seal_byte *allocate_aligned(size_t size)
+{
+    seal_byte *buffer = static_cast<seal_byte *>(aligned_alloc(INDEX_FILE_ALIGNMENT, size));
+    if (!buffer)
+    {
+        throw bad_alloc();
+    }
+    memset(buffer, 0, size);
+    return buffer;
+}
+
+static void pread_all(int fd, seal_byte *buffer, size_t size, off_t offset)
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        ssize_t num_read = pread(fd, buffer + total, size - total, offset + static_cast<off_t>(total));
+        if (num_read < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw runtime_error(string("index file read failed: ") + strerror(errno));
+        }
+        if (num_read == 0)
+        {
+            throw runtime_error("index file is truncated");
+        }
+        total += static_cast<size_t>(num_read);
+    }
+}
+
+IndexFileWriter::IndexFileWriter(const string &path, size_t record_bytes)
+    : path_(path), out_(path, ios::binary | ios::trunc), record_bytes_(round_up(record_bytes))
+{
+    if (!out_)
+    {
+        throw runtime_error("could not open " + path);
+    }
+
+    /* The header block is reserved here and filled in by close() */
+    vector<seal_byte> header_block(INDEX_FILE_ALIGNMENT, seal_byte{ 0 });
+    out_.write(reinterpret_cast<const char *>(header_block.data()), INDEX_FILE_ALIGNMENT);
+}
+
+IndexFileWriter::~IndexFileWriter()
+{
+    if (out_.is_open())
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+void IndexFileWriter::append(vector<Ciphertext> &encrypted_rows)
+{
+    if (!out_.is_open())
+    {
+        throw logic_error("index file is already closed");
+    }
+    if (record_bytes_ == 0 && !encrypted_rows.empty())
+    {
+        record_bytes_ = round_up(static_cast<size_t>(encrypted_rows[0].save_size(compr_mode_type::none)));
+    }
+    block_.resize(record_bytes_);
+
+    for (auto &encrypted_row : encrypted_rows)
+    {
+        if (static_cast<size_t>(encrypted_row.save_size(compr_mode_type::none)) > record_bytes_)
+        {
+            throw invalid_argument("row is larger than the records of the index file");
+        }
+        fill(block_.begin(), block_.end(), seal_byte{ 0 });
+        encrypted_row.save(block_.data(), record_bytes_, compr_mode_type::none);
+        out_.write(reinterpret_cast<const char *>(block_.data()), record_bytes_);
+        num_rows_++;
+    }
+    if (!out_)
+    {
+        throw runtime_error("could not write " + path_);
+    }
+}
+
+void IndexFileWriter::close()
+{
+    if (!out_.is_open())
+    {
+        return;
+    }
+
+    /* Header block: magic, number of rows and record size */
+    uint64_t header[3] = { INDEX_FILE_MAGIC, num_rows_, record_bytes_ };
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out_.close();
+    if (!out_)
+    {
+        throw runtime_error("could not write " + path_);
+    }
+}
+
+size_t IndexFileWriter::num_rows() const
+{
+    return num_rows_;
+}
+
+size_t IndexFileWriter::record_bytes() const
+{
+    return record_bytes_;
+}
+
+void write_index_file(const string &path, vector<Ciphertext> &encrypted_matrix)
+{
+    size_t record_bytes = 0;
+    for (auto &encrypted_row : encrypted_matrix)
+    {
+        record_bytes = max(record_bytes, static_cast<size_t>(encrypted_row.save_size(compr_mode_type::none)));
+    }
+
+    IndexFileWriter writer(path, record_bytes);
+    writer.append(encrypted_matrix);
+    writer.close();
+}
+
+PrefetchingReader::PrefetchingReader(SEALContext &context, const string &path, size_t ring_size, size_t num_reader_threads)
+    : context_(context)
+{
+    /* Some file systems, such as tmpfs, refuse O_DIRECT */
+    fd_ = open(path.c_str(), O_RDONLY | O_DIRECT);
+    direct_io_ = fd_ >= 0;
+    if (fd_ < 0 && errno == EINVAL)
+    {
+        fd_ = open(path.c_str(), O_RDONLY);
+    }
+    if (fd_ < 0)
+    {
+        throw runtime_error("could not open " + path + ": " + strerror(errno));
+    }
+
+    seal_byte *header_block = allocate_aligned(INDEX_FILE_ALIGNMENT);
+    try
+    {
+        pread_all(fd_, header_block, INDEX_FILE_ALIGNMENT, 0);
+    }
+    catch (...)
+    {
+        free(header_block);
+        close(fd_);
+        throw;
+    }
+    uint64_t header[3];
+    memcpy(header, header_block, sizeof(header));
+    free(header_block);
+    if (header[0] != INDEX_FILE_MAGIC || header[2] % INDEX_FILE_ALIGNMENT != 0)
+    {
+        close(fd_);
+        throw runtime_error(path + " is not an index file");
+    }
+    num_rows_ = header[1];
+    record_bytes_ = header[2];
+
+    slots_.resize(max<size_t>(ring_size, 1));
+    for (auto &slot : slots_)
+    {
+        slot.buffer = allocate_aligned(record_bytes_);
+    }
+    if (ring_size > 0)
+    {
+        for (size_t t = 0; t < max<size_t>(num_reader_threads, 1); t++)
+        {
+            readers_.emplace_back(&PrefetchingReader::run, this);
+        }
+    }
+}
+
+PrefetchingReader::~PrefetchingReader()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    slot_changed_.notify_all();
+    for (auto &reader : readers_)
+    {
+        reader.join();
+    }
+    for (auto &slot : slots_)
+    {
+        free(slot.buffer);
+    }
+    close(fd_);
+}
+
+void PrefetchingReader::read_record(size_t row, seal_byte *buffer)
+{
+    pread_all(fd_, buffer, record_bytes_, static_cast<off_t>(INDEX_FILE_ALIGNMENT + row * record_bytes_));
+}
+
+void PrefetchingReader::run()
+{
+    size_t ring_size = slots_.size();
+    while (true)
+    {
+        unique_lock<mutex> lock(mutex_);
+        if (stopping_ || next_read_ >= num_rows_)
+        {
+            return;
+        }
+        size_t row = next_read_++;
+
+        /* The slot is free once the row ring_size places before this one has been loaded */
+        slot_changed_.wait(lock, [&]() { return stopping_ || row < next_row_ + ring_size; });
+        if (stopping_)
+        {
+            return;
+        }
+        Slot &slot = slots_[row % ring_size];
+        lock.unlock();
+
+        auto time_start = chrono::steady_clock::now();
+        try
+        {
+            read_record(row, slot.buffer);
+        }
+        catch (...)
+        {
+            /* Hand the error to next() instead of terminating, and stop the other readers */
+            lock.lock();
+            if (!error_)
+            {
+                error_ = current_exception();
+            }
+            stopping_ = true;
+            lock.unlock();
+            slot_changed_.notify_all();
+            return;
+        }
+        auto time_end = chrono::steady_clock::now();
+
+        lock.lock();
+        slot.row = row;
+        slot.ready = true;
+        stats_.bytes_read += record_bytes_;
+        stats_.read_microseconds += chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        lock.unlock();
+        slot_changed_.notify_all();
+    }
+}
+
+bool PrefetchingReader::next(Ciphertext &encrypted_row)
+{
+    if (next_row_ >= num_rows_)
+    {
+        return false;
+    }
+
+    if (readers_.empty())
+    {
+        auto time_start = chrono::steady_clock::now();
+        read_record(next_row_, slots_[0].buffer);
+        auto time_end = chrono::steady_clock::now();
+        int64_t read_time = chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        encrypted_row.load(context_, slots_[0].buffer, record_bytes_);
+
+        lock_guard<mutex> lock(mutex_);
+        stats_.bytes_read += record_bytes_;
+        stats_.read_microseconds += read_time;
+        stats_.wait_microseconds += read_time;
+        next_row_++;
+        return true;
+    }
+
+    Slot &slot = slots_[next_row_ % slots_.size()];
+    {
+        unique_lock<mutex> lock(mutex_);
+        auto time_start = chrono::steady_clock::now();
+        slot_changed_.wait(lock, [&]() { return (slot.ready && slot.row == next_row_) || error_; });
+        auto time_end = chrono::steady_clock::now();
+        stats_.wait_microseconds += chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        if (!slot.ready || slot.row != next_row_)
+        {
+            rethrow_exception(error_);
+        }
+    }
+
+    /* Readers never touch a ready slot, so it can be loaded without the lock */
+    encrypted_row.load(context_, slot.buffer, record_bytes_);
+    {
+        lock_guard<mutex> lock(mutex_);
+        slot.ready = false;
+        next_row_++;
+    }
+    slot_changed_.notify_all();
+    return true;
+}
+
+size_t PrefetchingReader::num_rows() const
+{
+    return num_rows_;
+}
+
+size_t PrefetchingReader::record_bytes() const
+{
+    return record_bytes_;
+}
+
+bool PrefetchingReader::direct_io() const
+{
+    return direct_io_;
+}
+
+ReaderStats PrefetchingReader::stats()
+{
+    lock_guard<mutex> lock(mutex_);
+    return stats_;
+}
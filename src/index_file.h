@@ -0,0 +1,113 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <condition_variable>
+
+using namespace std;
+using namespace seal;
+
+/* Offsets and record sizes in an index file are multiples of this, as O_DIRECT requires */
+constexpr size_t INDEX_FILE_ALIGNMENT = 4096;
+
+/*
+Writes an index file a block of rows at a time, so that an index larger than
+memory can be built without holding every row. The rows are fixed-size
+records after a one-block header, so that row i can be read with a single
+aligned read at a known offset. With a record_bytes of 0, the record size is
+taken from the first row appended, which fits every fresh encryption under
+the same parameters. The header is written by close().
+*/
+class IndexFileWriter
+{
+public:
+    IndexFileWriter(const string &path, size_t record_bytes = 0);
+
+    /* Closes the file if close() was not called, ignoring errors */
+    ~IndexFileWriter();
+
+    IndexFileWriter(const IndexFileWriter &) = delete;
+
+    IndexFileWriter &operator=(const IndexFileWriter &) = delete;
+
+    void append(vector<Ciphertext> &encrypted_rows);
+
+    /* Writes the header with the final number of rows */
+    void close();
+
+    size_t num_rows() const;
+
+    size_t record_bytes() const;
+
+private:
+    string path_;
+    ofstream out_;
+    size_t record_bytes_;
+    size_t num_rows_ = 0;
+    vector<seal_byte> block_;
+};
+
+/* Writes every row at once, with records as large as the largest row */
+void write_index_file(const string &path, vector<Ciphertext> &encrypted_matrix);
+
+struct ReaderStats
+{
+    size_t bytes_read = 0;
+    int64_t read_microseconds = 0;   // Summed over the reader threads
+    int64_t wait_microseconds = 0;   // Time next() spent waiting for storage
+};
+
+/*
+Reads the rows of an index file in order. Reader threads read ahead into a
+ring of ring_size aligned buffers, bypassing the page cache with O_DIRECT
+when the file system supports it, while the caller loads and evaluates the
+rows it has already been given. A reader only reuses a buffer after the row
+in it has been loaded, so at most ring_size rows are held in memory. With a
+ring_size of 0, every row is read synchronously inside next(). A read error
+in a reader thread stops the readers and is rethrown by next().
+*/
+class PrefetchingReader
+{
+public:
+    PrefetchingReader(SEALContext &context, const string &path, size_t ring_size, size_t num_reader_threads = 1);
+
+    ~PrefetchingReader();
+
+    /* Loads the next row, returning false once every row has been returned */
+    bool next(Ciphertext &encrypted_row);
+
+    size_t num_rows() const;
+
+    size_t record_bytes() const;
+
+    bool direct_io() const;
+
+    ReaderStats stats();
+
+private:
+    struct Slot
+    {
+        seal_byte *buffer = nullptr;
+        size_t row = 0;
+        bool ready = false;
+    };
+
+    void read_record(size_t row, seal_byte *buffer);
+
+    void run();
+
+    SEALContext &context_;
+    int fd_ = -1;
+    bool direct_io_ = false;
+    size_t num_rows_ = 0;
+    size_t record_bytes_ = 0;
+
+    mutex mutex_;
+    condition_variable slot_changed_;
+    vector<Slot> slots_;
+    size_t next_row_ = 0;    // Next row returned by next()
+    size_t next_read_ = 0;   // Next row claimed by a reader thread
+    bool stopping_ = false;
+    exception_ptr error_;
+    ReaderStats stats_;
+    vector<thread> readers_;
+};
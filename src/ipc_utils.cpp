@@ -0,0 +1,127 @@
+#include "native/examples/examples.h"
+#include "ipc_utils.h"
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace seal;
+
+/* MSG_NOSIGNAL turns a closed peer into EPIPE instead of a SIGPIPE that kills the process */
+static void write_all(int fd, const char *data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t written = send(fd, data, size, MSG_NOSIGNAL);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw runtime_error(string("send failed: ") + strerror(errno));
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+/* Returns false if the other end was closed before any byte was read */
+static bool read_all(int fd, char *data, size_t size)
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        ssize_t num_read = read(fd, data + total, size - total);
+        if (num_read < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw runtime_error(string("read failed: ") + strerror(errno));
+        }
+        if (num_read == 0)
+        {
+            if (total == 0)
+            {
+                return false;
+            }
+            throw runtime_error("connection closed in the middle of a message");
+        }
+        total += static_cast<size_t>(num_read);
+    }
+    return true;
+}
+
+void send_message(int fd, const string &message)
+{
+    uint64_t size = message.size();
+    write_all(fd, reinterpret_cast<const char *>(&size), sizeof(size));
+    write_all(fd, message.data(), message.size());
+}
+
+bool recv_message(int fd, string &message, uint64_t max_bytes)
+{
+    uint64_t size;
+    if (!read_all(fd, reinterpret_cast<char *>(&size), sizeof(size)))
+    {
+        return false;
+    }
+    if (size > max_bytes)
+    {
+        throw runtime_error("message of " + to_string(size) + " bytes is above the limit of " + to_string(max_bytes));
+    }
+    message.resize(size);
+    if (size > 0 && !read_all(fd, &message[0], size))
+    {
+        throw runtime_error("connection closed in the middle of a message");
+    }
+    return true;
+}
+
+string serialize_ciphertexts(vector<Ciphertext> &vector_of_encrypted, compr_mode_type compr_mode)
+{
+    /* The count is followed by the ciphertexts, each of which records its own size */
+    stringstream stream;
+    uint64_t count = vector_of_encrypted.size();
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    for (size_t i = 0; i < vector_of_encrypted.size(); i++)
+    {
+        vector_of_encrypted[i].save(stream, compr_mode);
+    }
+    return stream.str();
+}
+
+size_t max_ciphertext_bytes(SEALContext &context)
+{
+    auto &parms = context.first_context_data()->parms();
+    size_t data_bytes = 2 * parms.poly_modulus_degree() * parms.coeff_modulus().size() * sizeof(uint64_t);
+
+    /* Room for the headers, and for compression that does not manage to shrink the data */
+    return data_bytes + data_bytes / 16 + 4096;
+}
+
+vector<Ciphertext> deserialize_ciphertexts(SEALContext &context, const string &serialized, size_t max_count)
+{
+    stringstream stream(serialized);
+    uint64_t count;
+    if (!stream.read(reinterpret_cast<char *>(&count), sizeof(count)))
+    {
+        throw runtime_error("serialized ciphertexts are truncated");
+    }
+
+    /* Every ciphertext starts with a SEAL header, which bounds the count before anything is allocated */
+    uint64_t max_count_in_data = (serialized.size() - sizeof(count)) / sizeof(Serialization::SEALHeader);
+    if (count > max_count || count > max_count_in_data)
+    {
+        throw runtime_error("serialized ciphertexts have an invalid count of " + to_string(count));
+    }
+    vector<Ciphertext> vector_of_encrypted(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        vector_of_encrypted[i].load(context, stream);
+    }
+    return vector_of_encrypted;
+}
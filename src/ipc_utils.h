@@ -0,0 +1,28 @@
+#pragma once
+
+#include "native/examples/examples.h"
+
+using namespace std;
+using namespace seal;
+
+/* Writes a length-prefixed message to a socket */
+void send_message(int fd, const string &message);
+
+/* Largest message recv_message accepts unless the caller gives a tighter bound */
+const uint64_t DEFAULT_MAX_MESSAGE_BYTES = uint64_t(1) << 30;
+
+/*
+Reads a length-prefixed message, returning false if the other end was
+closed. A length above max_bytes throws before anything is allocated, and
+the connection should then be closed, since the rest of the message is
+left unread.
+*/
+bool recv_message(int fd, string &message, uint64_t max_bytes = DEFAULT_MAX_MESSAGE_BYTES);
+
+/* Upper bound on the serialized size of one relinearized ciphertext at the first level */
+size_t max_ciphertext_bytes(SEALContext &context);
+
+string serialize_ciphertexts(vector<Ciphertext> &vector_of_encrypted, compr_mode_type compr_mode = compr_mode_type::none);
+
+/* Throws if the count is above max_count or more than the data could hold */
+vector<Ciphertext> deserialize_ciphertexts(SEALContext &context, const string &serialized, size_t max_count = SIZE_MAX);
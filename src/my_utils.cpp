@@ -1,5 +1,6 @@
 #include "native/examples/examples.h"
 #include "my_utils.h"
+#include "perf_counters.h"
 
 using namespace std;
 using namespace seal;
@@ -21,21 +22,9 @@ Ciphertext BFV_dot_product(
     Ciphertext &encrypted1, Ciphertext &encrypted2, size_t dimension
 )
 {
-    /* Multiply the two ciphertexts */
-    Ciphertext product;
-    evaluator.multiply(encrypted1, encrypted2, product);
-    evaluator.relinearize_inplace(product, relin_keys);
-
-    /* Repeatedly rotate and add */
-    for (size_t rotation_steps = dimension / 2; rotation_steps >= 1; rotation_steps /= 2)
-    {
-        Ciphertext product_rotated;
-        evaluator.rotate_rows(product, rotation_steps, galois_keys, product_rotated);
-
-        evaluator.add_inplace(product, product_rotated);
-    }
-
-    return product;
+    /* A single product; loops over rows build one engine and reuse it */
+    DotProductEngine<BFVScheme> engine(evaluator, relin_keys, galois_keys, dimension);
+    return engine.dot_product(encrypted1, encrypted2);
 }
 
 uint64_t BFV_result(Decryptor &decryptor, BatchEncoder &batch_encoder, Ciphertext &encrypted)
@@ -65,22 +54,9 @@ Ciphertext CKKS_dot_product(
     Ciphertext &encrypted1, Ciphertext &encrypted2, size_t dimension
 )
 {
-    /* Multiply the two ciphertexts */
-    Ciphertext product;
-    evaluator.multiply(encrypted1, encrypted2, product);
-    evaluator.relinearize_inplace(product, relin_keys);
-    evaluator.rescale_to_next_inplace(product);
-
-    /* Repeatedly rotate and add */
-    for (size_t rotation_steps = dimension / 2; rotation_steps >= 1; rotation_steps /= 2)
-    {
-        Ciphertext product_rotated;
-        evaluator.rotate_vector(product, rotation_steps, galois_keys, product_rotated);
-
-        evaluator.add_inplace(product, product_rotated);
-    }
-
-    return product;
+    /* A single product; loops over rows build one engine and reuse it */
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension);
+    return engine.dot_product(encrypted1, encrypted2);
 }
 
 double CKKS_result(Decryptor &decryptor, CKKSEncoder &encoder, Ciphertext &encrypted)
@@ -111,13 +87,8 @@ vector<Ciphertext> CKKS_matrix_vector_product(
     vector<Ciphertext> &encrypted_matrix, Ciphertext &encrypted_vector, size_t dimension
 )
 {
-    vector<Ciphertext> product_vector(encrypted_matrix.size());
-    for (size_t i = 0; i < encrypted_matrix.size(); i++)
-    {
-        Ciphertext other_encrypted_vector = encrypted_matrix[i];
-        product_vector[i] = CKKS_dot_product(evaluator, relin_keys, galois_keys, other_encrypted_vector, encrypted_vector, dimension);
-    }
-    return product_vector;
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension);
+    return engine.matrix_vector_product(encrypted_matrix, encrypted_vector);
 }
 
 vector<double> CKKS_results(Decryptor &decryptor, CKKSEncoder &encoder, vector<Ciphertext> &vector_of_encrypted)
@@ -195,4 +166,400 @@ vector<double> packed_CKKS_results(
         }
     }
     return results;
-}
\ No newline at end of file
+}
+
+void parallel_packed_CKKS_results(
+    SEALContext &context, SecretKey &secret_key, vector<Ciphertext> &vector_of_encrypted, 
+    size_t dimension, size_t num_vecs_per_row, vector<double> &results, 
+    size_t num_threads, bool switch_to_last_level
+)
+{
+    if (num_threads == 0)
+    {
+        num_threads = thread::hardware_concurrency();
+    }
+    num_threads = max<size_t>(1, min(num_threads, vector_of_encrypted.size()));
+    results.resize(vector_of_encrypted.size() * num_vecs_per_row);
+    Evaluator evaluator(context);
+    parms_id_type last_parms_id = context.last_parms_id();
+
+    auto decrypt_range = [&](size_t t) {
+        Decryptor decryptor(context, secret_key);
+        CKKSEncoder encoder(context);
+        Ciphertext switched;
+        Plaintext plain_result;
+        vector<double> vec_result;
+
+        size_t begin = vector_of_encrypted.size() * t / num_threads;
+        size_t end = vector_of_encrypted.size() * (t + 1) / num_threads;
+        for (size_t row_num = begin; row_num < end; row_num++)
+        {
+            const Ciphertext *encrypted = &vector_of_encrypted[row_num];
+            if (switch_to_last_level && encrypted->parms_id() != last_parms_id)
+            {
+                /* Only the primes that are kept are copied */
+                evaluator.mod_switch_to_next(*encrypted, switched);
+                while (switched.parms_id() != last_parms_id)
+                {
+                    evaluator.mod_switch_to_next_inplace(switched);
+                }
+                encrypted = &switched;
+            }
+            decryptor.decrypt(*encrypted, plain_result);
+            encoder.decode(plain_result, vec_result);
+            for (size_t j = 0; j < num_vecs_per_row; j++)
+            {
+                results[row_num*num_vecs_per_row + j] = vec_result[j * dimension];
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t t = 1; t < num_threads; t++)
+    {
+        threads.emplace_back(decrypt_range, t);
+    }
+    decrypt_range(0);
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+}
+
+/* Helper functions for database ingest */
+void CKKS_encrypt_rows(
+    SEALContext &context, PublicKey &public_key, double scale, 
+    vector<vector<double>> &matrix, vector<Ciphertext> &encrypted_matrix, size_t num_threads
+)
+{
+    if (num_threads == 0)
+    {
+        num_threads = max<size_t>(1, thread::hardware_concurrency());
+    }
+    num_threads = max<size_t>(1, min(num_threads, matrix.size()));
+    encrypted_matrix.resize(matrix.size());
+
+    /* 
+    Each encryption draws its randomness from a freshly seeded generator, so
+    the per-thread encryptors produce independent streams.
+    */
+    auto encrypt_range = [&](size_t begin, size_t end) {
+        CKKSEncoder encoder(context);
+        Encryptor encryptor(context, public_key);
+        MemoryPoolHandle pool = MemoryPoolHandle::New();
+        Plaintext plain_vector(pool);
+        for (size_t i = begin; i < end; i++)
+        {
+            encoder.encode(matrix[i], scale, plain_vector, pool);
+            encryptor.encrypt(plain_vector, encrypted_matrix[i], pool);
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t t = 1; t < num_threads; t++)
+    {
+        threads.emplace_back(encrypt_range, matrix.size() * t / num_threads, matrix.size() * (t + 1) / num_threads);
+    }
+    encrypt_range(0, matrix.size() / num_threads);
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+}
+
+
+/* Helper functions for products with a prepared query */
+PreparedQuery prepare_query(SEALContext &context, Evaluator &evaluator, Ciphertext &encrypted_vector, parms_id_type row_parms_id)
+{
+    auto query_data = context.get_context_data(encrypted_vector.parms_id());
+    auto row_data = context.get_context_data(row_parms_id);
+    if (!query_data || !row_data || query_data->chain_index() < row_data->chain_index())
+    {
+        throw invalid_argument("query must be at or above the level of the rows");
+    }
+
+    PreparedQuery query;
+    query.encrypted = encrypted_vector;
+    if (encrypted_vector.parms_id() != row_parms_id)
+    {
+        evaluator.mod_switch_to_inplace(query.encrypted, row_parms_id);
+    }
+    return query;
+}
+
+PreparedQuery prepare_plain_query(CKKSEncoder &encoder, vector<double> &duplicated_vec, double scale, parms_id_type row_parms_id)
+{
+    PreparedQuery query;
+    encoder.encode(duplicated_vec, row_parms_id, scale, query.plain);
+    query.is_plain = true;
+    return query;
+}
+
+Ciphertext CKKS_dot_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    Ciphertext &encrypted_row, const PreparedQuery &query, size_t dimension, 
+    MemoryPoolHandle pool
+)
+{
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension, pool);
+    return CKKS_dot_product(engine, encrypted_row, query);
+}
+
+Ciphertext CKKS_dot_product(DotProductEngine<CKKSScheme> &engine, Ciphertext &encrypted_row, const PreparedQuery &query)
+{
+    /* The product with a plaintext query needs no relinearization */
+    if (query.is_plain)
+    {
+        return engine.dot_product(encrypted_row, query.plain);
+    }
+    return engine.dot_product(encrypted_row, query.encrypted);
+}
+
+vector<Ciphertext> CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    vector<Ciphertext> &encrypted_matrix, const PreparedQuery &query, size_t dimension
+)
+{
+    /* Rows are used in place instead of being copied */
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension);
+    vector<Ciphertext> product_vector(encrypted_matrix.size());
+    for (size_t i = 0; i < encrypted_matrix.size(); i++)
+    {
+        product_vector[i] = CKKS_dot_product(engine, encrypted_matrix[i], query);
+    }
+    return product_vector;
+}
+
+vector<Ciphertext> parallel_CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    vector<Ciphertext> &encrypted_matrix, const PreparedQuery &query, size_t dimension, 
+    size_t num_threads, vector<MemoryPoolHandle> pools
+)
+{
+    num_threads = max<size_t>(1, min(num_threads, encrypted_matrix.size()));
+    pools.resize(num_threads, MemoryManager::GetPool());
+
+    vector<Ciphertext> product_vector(encrypted_matrix.size());
+    auto evaluate_range = [&](size_t t) {
+        size_t begin = encrypted_matrix.size() * t / num_threads;
+        size_t end = encrypted_matrix.size() * (t + 1) / num_threads;
+        DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension, pools[t]);
+        for (size_t i = begin; i < end; i++)
+        {
+            product_vector[i] = CKKS_dot_product(engine, encrypted_matrix[i], query);
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t t = 1; t < num_threads; t++)
+    {
+        threads.emplace_back(evaluate_range, t);
+    }
+    evaluate_range(0);
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+    return product_vector;
+}
+
+
+/* Helper functions for profiling the phases of the product */
+vector<Ciphertext> profiled_CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    vector<Ciphertext> &encrypted_matrix, Ciphertext &encrypted_vector, size_t dimension, 
+    PhaseProfiler &profiler
+)
+{
+    /* Same steps as CKKS_dot_product, with each phase measured separately */
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension);
+    vector<Ciphertext> product_vector(encrypted_matrix.size());
+    for (size_t i = 0; i < encrypted_matrix.size(); i++)
+    {
+        Ciphertext &product = product_vector[i];
+        profiler.begin(query_phase::multiply);
+        evaluator.multiply(encrypted_matrix[i], encrypted_vector, product);
+        profiler.end(query_phase::multiply);
+
+        profiler.begin(query_phase::relinearize);
+        evaluator.relinearize_inplace(product, relin_keys);
+        profiler.end(query_phase::relinearize);
+
+        profiler.begin(query_phase::rescale);
+        evaluator.rescale_to_next_inplace(product);
+        profiler.end(query_phase::rescale);
+
+        profiler.begin(query_phase::rotation_reduction);
+        engine.rotation_reduction(product);
+        profiler.end(query_phase::rotation_reduction);
+    }
+    return product_vector;
+}
+
+vector<double> profiled_packed_CKKS_results(
+    Decryptor &decryptor, CKKSEncoder &encoder, vector<Ciphertext> &vector_of_encrypted, 
+    size_t dimension, size_t num_vecs_per_row, PhaseProfiler &profiler
+)
+{
+    profiler.begin(query_phase::decrypt_decode);
+    vector<double> results = packed_CKKS_results(decryptor, encoder, vector_of_encrypted, dimension, num_vecs_per_row);
+    profiler.end(query_phase::decrypt_decode);
+    return results;
+}
+
+
+/* Helper functions for timing */
+int64_t percentile(vector<int64_t> values, double fraction)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    sort(values.begin(), values.end());
+    size_t index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+    return values[min(index, values.size() - 1)];
+}
+
+static PublicKey create_public_key(KeyGenerator &keygen)
+{
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    return public_key;
+}
+
+ProductTestSetup::ProductTestSetup(const EncryptionParameters &parms)
+    : context(parms), keygen(context), secret_key(keygen.secret_key()), public_key(create_public_key(keygen)),
+      encryptor(context, public_key), evaluator(context), decryptor(context, secret_key)
+{
+    keygen.create_relin_keys(relin_keys);
+    keygen.create_galois_keys(galois_keys);
+}
+
+vector<int64_t> time_product_variants(
+    const vector<product_variant> &variants, vector<Ciphertext> &encrypted_matrix,
+    vector<vector<Ciphertext>> &product_vectors, size_t reps
+)
+{
+    product_vectors.assign(variants.size(), vector<Ciphertext>(encrypted_matrix.size()));
+    for (size_t v = 0; v < variants.size(); v++)
+    {
+        for (size_t i = 0; i < encrypted_matrix.size(); i++)
+        {
+            variants[v](encrypted_matrix[i], product_vectors[v][i]);
+        }
+    }
+
+    vector<int64_t> times(variants.size(), 0);
+    for (size_t rep = 0; rep < reps; rep++)
+    {
+        for (size_t k = 0; k < variants.size(); k++)
+        {
+            size_t v = (rep + k) % variants.size();
+            auto time_start = chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < encrypted_matrix.size(); i++)
+            {
+                variants[v](encrypted_matrix[i], product_vectors[v][i]);
+            }
+            auto time_end = chrono::high_resolution_clock::now();
+            times[v] += chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        }
+    }
+    return times;
+}
+
+
+/* Helper functions for cascaded search */
+PCAProjection fit_pca(vector<vector<double>> &vectors, size_t num_components)
+{
+    size_t dimension = vectors[0].size();
+    PCAProjection projection;
+    projection.mean.assign(dimension, 0);
+    for (auto &vec : vectors)
+    {
+        for (size_t i = 0; i < dimension; i++)
+        {
+            projection.mean[i] += vec[i] / vectors.size();
+        }
+    }
+
+    vector<vector<double>> covariance(dimension, vector<double>(dimension, 0));
+    for (auto &vec : vectors)
+    {
+        for (size_t i = 0; i < dimension; i++)
+        {
+            double centered_i = vec[i] - projection.mean[i];
+            for (size_t j = 0; j < dimension; j++)
+            {
+                covariance[i][j] += centered_i * (vec[j] - projection.mean[j]) / vectors.size();
+            }
+        }
+    }
+
+    /* Orthogonal iteration from a fixed random start */
+    mt19937 gen(0);
+    normal_distribution<double> normal(0, 1);
+    vector<vector<double>> &components = projection.components;
+    components.assign(num_components, vector<double>(dimension));
+    for (auto &component : components)
+    {
+        for (double &value : component)
+        {
+            value = normal(gen);
+        }
+    }
+    for (size_t iteration = 0; iteration < 100; iteration++)
+    {
+        for (size_t c = 0; c < num_components; c++)
+        {
+            vector<double> next(dimension, 0);
+            for (size_t i = 0; i < dimension; i++)
+            {
+                for (size_t j = 0; j < dimension; j++)
+                {
+                    next[i] += covariance[i][j] * components[c][j];
+                }
+            }
+
+            /* Gram-Schmidt against the components before it */
+            for (size_t p = 0; p < c; p++)
+            {
+                double overlap = inner_product(next.begin(), next.end(), components[p].begin(), 0.0);
+                for (size_t i = 0; i < dimension; i++)
+                {
+                    next[i] -= overlap * components[p][i];
+                }
+            }
+            double norm = sqrt(inner_product(next.begin(), next.end(), next.begin(), 0.0));
+            for (size_t i = 0; i < dimension; i++)
+            {
+                components[c][i] = norm > 0 ? next[i] / norm : 0;
+            }
+        }
+    }
+    return projection;
+}
+
+vector<double> pca_project(const PCAProjection &projection, const vector<double> &vec, bool center)
+{
+    vector<double> projected(projection.components.size(), 0);
+    for (size_t c = 0; c < projection.components.size(); c++)
+    {
+        for (size_t i = 0; i < vec.size(); i++)
+        {
+            projected[c] += projection.components[c][i] * (center ? vec[i] - projection.mean[i] : vec[i]);
+        }
+    }
+    return projected;
+}
+
+vector<size_t> top_k_indices(const vector<double> &scores, size_t k)
+{
+    vector<size_t> indices(scores.size());
+    iota(indices.begin(), indices.end(), 0);
+    k = min(k, indices.size());
+    partial_sort(indices.begin(), indices.begin() + k, indices.end(), [&](size_t a, size_t b) {
+        return scores[a] > scores[b];
+    });
+    indices.resize(k);
+    return indices;
+}
@@ -1,8 +1,14 @@
+#pragma once
+
 #include "native/examples/examples.h"
+#include "dot_product_engine.h"
+#include <functional>
 
 using namespace std;
 using namespace seal;
 
+class PhaseProfiler;
+
 uint64_t vec_int_dot_product(vector<uint64_t> vec1, vector<uint64_t> vec2, size_t dimension);
 
 Ciphertext BFV_dot_product(
@@ -39,4 +45,123 @@ vector<double> packed_matrix_vec_product(vector<vector<double>> packed_matrix, v
 vector<double> packed_CKKS_results(
     Decryptor &decryptor, CKKSEncoder &encoder, vector<Ciphertext> &vector_of_encrypted, 
     size_t dimension, size_t num_vecs_per_row
-);
\ No newline at end of file
+);
+
+/*
+Decrypts and decodes the results across num_threads threads (0 for one per
+hardware thread), each with its own decryptor, encoder and scratch buffers,
+and writes the dot products straight into results. The ciphertexts are not
+copied; unless switch_to_last_level is false, each is first switched to the
+last level, where decryption and decoding only work with a single prime.
+*/
+void parallel_packed_CKKS_results(
+    SEALContext &context, SecretKey &secret_key, vector<Ciphertext> &vector_of_encrypted, 
+    size_t dimension, size_t num_vecs_per_row, vector<double> &results, 
+    size_t num_threads = 0, bool switch_to_last_level = true
+);
+
+/* 
+Encodes and encrypts every row of the matrix into encrypted_matrix, which is
+resized to fit. Rows are split into contiguous ranges across num_threads
+threads (0 for one per hardware thread), each with its own encoder,
+encryptor, scratch plaintext and memory pool.
+*/
+void CKKS_encrypt_rows(
+    SEALContext &context, PublicKey &public_key, double scale, 
+    vector<vector<double>> &matrix, vector<Ciphertext> &encrypted_matrix, size_t num_threads = 0
+);
+
+/* Query side state that is computed once and reused for every row */
+struct PreparedQuery
+{
+    Ciphertext encrypted;   // Switched to the level of the rows
+    Plaintext plain;        // Encoded at the level of the rows, in plaintext mode
+    bool is_plain = false;
+};
+
+PreparedQuery prepare_query(SEALContext &context, Evaluator &evaluator, Ciphertext &encrypted_vector, parms_id_type row_parms_id);
+
+PreparedQuery prepare_plain_query(CKKSEncoder &encoder, vector<double> &duplicated_vec, double scale, parms_id_type row_parms_id);
+
+Ciphertext CKKS_dot_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    Ciphertext &encrypted_row, const PreparedQuery &query, size_t dimension, 
+    MemoryPoolHandle pool = MemoryManager::GetPool()
+);
+
+/* The same product with an engine that is built once per scan or thread */
+Ciphertext CKKS_dot_product(DotProductEngine<CKKSScheme> &engine, Ciphertext &encrypted_row, const PreparedQuery &query);
+
+vector<Ciphertext> CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    vector<Ciphertext> &encrypted_matrix, const PreparedQuery &query, size_t dimension
+);
+
+/*
+Splits the rows into contiguous ranges across threads. Thread t allocates
+its scratch and result ciphertexts from pools[t] if given, and from the
+global pool otherwise.
+*/
+vector<Ciphertext> parallel_CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    vector<Ciphertext> &encrypted_matrix, const PreparedQuery &query, size_t dimension, 
+    size_t num_threads, vector<MemoryPoolHandle> pools = {}
+);
+
+/* Helper functions for profiling the phases of the product */
+vector<Ciphertext> profiled_CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys, 
+    vector<Ciphertext> &encrypted_matrix, Ciphertext &encrypted_vector, size_t dimension, 
+    PhaseProfiler &profiler
+);
+
+vector<double> profiled_packed_CKKS_results(
+    Decryptor &decryptor, CKKSEncoder &encoder, vector<Ciphertext> &vector_of_encrypted, 
+    size_t dimension, size_t num_vecs_per_row, PhaseProfiler &profiler
+);
+
+/* Helper functions for timing */
+int64_t percentile(vector<int64_t> values, double fraction);
+
+/* Context, keys and object instances shared by the dot product comparisons of Tests 20 and 21 */
+struct ProductTestSetup
+{
+    ProductTestSetup(const EncryptionParameters &parms);
+
+    SEALContext context;
+    KeyGenerator keygen;
+    SecretKey secret_key;
+    PublicKey public_key;
+    RelinKeys relin_keys;
+    GaloisKeys galois_keys;  // Every power of two
+    Encryptor encryptor;
+    Evaluator evaluator;
+    Decryptor decryptor;
+};
+
+using product_variant = function<void(Ciphertext &, Ciphertext &)>;
+
+/*
+Runs every variant once over the rows untimed, then reps times with the
+variants taking turns going first. Returns the total microseconds of each
+variant, whose products are left in product_vectors.
+*/
+vector<int64_t> time_product_variants(
+    const vector<product_variant> &variants, vector<Ciphertext> &encrypted_matrix,
+    vector<vector<Ciphertext>> &product_vectors, size_t reps
+);
+
+/* Helper functions for cascaded search */
+struct PCAProjection
+{
+    vector<double> mean;
+    vector<vector<double>> components;  // Orthonormal, by decreasing variance
+};
+
+PCAProjection fit_pca(vector<vector<double>> &vectors, size_t num_components);
+
+/* Projects onto the components, after subtracting the mean if center is set */
+vector<double> pca_project(const PCAProjection &projection, const vector<double> &vec, bool center = true);
+
+/* Indices of the k largest scores, largest first */
+vector<size_t> top_k_indices(const vector<double> &scores, size_t k);
@@ -0,0 +1,273 @@
+#include "native/examples/examples.h"
+#include "perf_counters.h"
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace seal;
+
+string perf_counter_name(perf_counter_type event)
+{
+    switch (event)
+    {
+    case perf_counter_type::cycles:
+        return "cycles";
+    case perf_counter_type::instructions:
+        return "instructions";
+    case perf_counter_type::llc_misses:
+        return "LLC misses";
+    case perf_counter_type::dtlb_misses:
+        return "dTLB misses";
+    case perf_counter_type::branch_misses:
+        return "branch misses";
+    }
+    return "unknown";
+}
+
+/* Layout of a read with PERF_FORMAT_TOTAL_TIME_ENABLED and PERF_FORMAT_TOTAL_TIME_RUNNING */
+struct counter_reading
+{
+    uint64_t value;
+    uint64_t time_enabled;
+    uint64_t time_running;
+};
+
+static int open_counter(perf_counter_type event, int group_fd)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    /* Members of a group only count while the leader is enabled */
+    attr.disabled = group_fd < 0 ? 1 : 0;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    switch (event)
+    {
+    case perf_counter_type::cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case perf_counter_type::instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case perf_counter_type::llc_misses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case perf_counter_type::dtlb_misses:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case perf_counter_type::branch_misses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        break;
+    }
+
+    /* Counts this thread, and the threads it starts later through inherit, on any CPU */
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+PerfCounters::PerfCounters(vector<perf_counter_type> events) : events_(move(events))
+{
+    /*
+    The first counter that opens leads a group, so that the PMU schedules
+    all of them together and the counts of one phase cover the same time.
+    A counter that cannot join the group is opened on its own.
+    */
+    int leader_fd = -1;
+    for (perf_counter_type event : events_)
+    {
+        int fd = open_counter(event, leader_fd);
+        if (fd < 0 && leader_fd >= 0)
+        {
+            fd = open_counter(event, -1);
+        }
+        if (leader_fd < 0)
+        {
+            leader_fd = fd;
+        }
+        fds_.push_back(fd);
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for (int fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+}
+
+void PerfCounters::start()
+{
+    for (int fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void PerfCounters::stop()
+{
+    for (int fd : fds_)
+    {
+        if (fd >= 0)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+}
+
+vector<uint64_t> PerfCounters::read() const
+{
+    vector<uint64_t> counts(fds_.size(), 0);
+    for (size_t i = 0; i < fds_.size(); i++)
+    {
+        counter_reading reading;
+        if (fds_[i] < 0 || ::read(fds_[i], &reading, sizeof(reading)) != sizeof(reading) || reading.time_running == 0)
+        {
+            continue;
+        }
+
+        /* Scale up counts that were multiplexed with other events for part of the time */
+        counts[i] = reading.value;
+        if (reading.time_running < reading.time_enabled)
+        {
+            counts[i] = static_cast<uint64_t>(
+                static_cast<double>(reading.value) * reading.time_enabled / reading.time_running
+            );
+        }
+    }
+    return counts;
+}
+
+bool PerfCounters::available(size_t index) const
+{
+    return fds_[index] >= 0;
+}
+
+bool PerfCounters::any_available() const
+{
+    return any_of(fds_.begin(), fds_.end(), [](int fd) { return fd >= 0; });
+}
+
+const vector<perf_counter_type> &PerfCounters::events() const
+{
+    return events_;
+}
+
+string query_phase_name(query_phase phase)
+{
+    switch (phase)
+    {
+    case query_phase::multiply:
+        return "multiply";
+    case query_phase::relinearize:
+        return "relinearize";
+    case query_phase::rescale:
+        return "rescale";
+    case query_phase::rotation_reduction:
+        return "rotation reduction";
+    case query_phase::decrypt_decode:
+        return "decrypt/decode";
+    }
+    return "unknown";
+}
+
+PhaseProfiler::PhaseProfiler(vector<perf_counter_type> events)
+    : counters_(move(events)), phase_times_(NUM_QUERY_PHASES, 0),
+      phase_counts_(NUM_QUERY_PHASES, vector<uint64_t>(counters_.events().size(), 0))
+{
+    /* The counters run for the lifetime of the profiler and each phase takes the difference */
+    counters_.start();
+}
+
+PhaseProfiler::~PhaseProfiler()
+{
+    counters_.stop();
+}
+
+void PhaseProfiler::begin(query_phase phase)
+{
+    if (in_phase_)
+    {
+        throw logic_error("phase " + query_phase_name(phase) + " began before " + query_phase_name(phase_) + " ended");
+    }
+    in_phase_ = true;
+    phase_ = phase;
+    phase_start_counts_ = counters_.read();
+    phase_start_time_ = chrono::high_resolution_clock::now();
+}
+
+void PhaseProfiler::end(query_phase phase)
+{
+    auto phase_end_time = chrono::high_resolution_clock::now();
+    vector<uint64_t> phase_end_counts = counters_.read();
+    if (!in_phase_ || phase != phase_)
+    {
+        throw logic_error("phase " + query_phase_name(phase) + " ended without a matching begin");
+    }
+    in_phase_ = false;
+
+    size_t index = static_cast<size_t>(phase);
+    phase_times_[index] += chrono::duration_cast<chrono::nanoseconds>(phase_end_time - phase_start_time_).count();
+    for (size_t e = 0; e < phase_end_counts.size(); e++)
+    {
+        phase_counts_[index][e] += phase_end_counts[e] - phase_start_counts_[e];
+    }
+}
+
+void PhaseProfiler::print_report(size_t num_rows) const
+{
+    num_rows = max<size_t>(1, num_rows);
+    streamsize old_precision = cout.precision();
+    const vector<perf_counter_type> &events = counters_.events();
+    if (!counters_.any_available())
+    {
+        cout << "Hardware counters are not available (see /proc/sys/kernel/perf_event_paranoid), "
+             << "reporting phase times only." << endl;
+    }
+
+    cout << "Per row averages by phase:" << endl;
+    cout << "  " << setw(20) << left << "phase" << right << setw(14) << "time (us)";
+    for (size_t e = 0; e < events.size(); e++)
+    {
+        if (counters_.available(e))
+        {
+            cout << setw(16) << perf_counter_name(events[e]);
+        }
+    }
+    cout << endl;
+
+    for (size_t p = 0; p < NUM_QUERY_PHASES; p++)
+    {
+        cout << "  " << setw(20) << left << query_phase_name(static_cast<query_phase>(p)) << right << setw(14) << fixed
+             << setprecision(1) << phase_times_[p] / 1000.0 / num_rows;
+        for (size_t e = 0; e < events.size(); e++)
+        {
+            if (counters_.available(e))
+            {
+                cout << setw(16) << phase_counts_[p][e] / num_rows;
+            }
+        }
+        cout << endl;
+    }
+    cout.unsetf(ios::fixed);
+    cout.precision(old_precision);
+}
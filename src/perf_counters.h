@@ -0,0 +1,105 @@
+#pragma once
+
+#include "native/examples/examples.h"
+
+using namespace std;
+using namespace seal;
+
+enum class perf_counter_type
+{
+    cycles,
+    instructions,
+    llc_misses,
+    dtlb_misses,
+    branch_misses
+};
+
+const vector<perf_counter_type> ALL_PERF_COUNTERS = {
+    perf_counter_type::cycles, perf_counter_type::instructions, perf_counter_type::llc_misses,
+    perf_counter_type::dtlb_misses, perf_counter_type::branch_misses
+};
+
+string perf_counter_name(perf_counter_type event);
+
+/*
+Hardware performance counters for the calling thread and the threads it
+starts afterwards, read through Linux perf_event_open. Counters that the
+kernel does not permit (see /proc/sys/kernel/perf_event_paranoid) or the
+hardware does not support are marked unavailable and read as zero, so
+callers can always report them. The counters are opened as one group, and
+counts are scaled by time_enabled / time_running if the kernel still had to
+multiplex them.
+*/
+class PerfCounters
+{
+public:
+    PerfCounters(vector<perf_counter_type> events);
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    /* Resets and enables every available counter */
+    void start();
+
+    void stop();
+
+    /* Counts since the last start, in the order of the events, scaled for multiplexing */
+    vector<uint64_t> read() const;
+
+    bool available(size_t index) const;
+
+    bool any_available() const;
+
+    const vector<perf_counter_type> &events() const;
+
+private:
+    vector<perf_counter_type> events_;
+    vector<int> fds_;
+};
+
+/* Phases of the query pipeline */
+enum class query_phase
+{
+    multiply,
+    relinearize,
+    rescale,
+    rotation_reduction,
+    decrypt_decode
+};
+
+const size_t NUM_QUERY_PHASES = 5;
+
+string query_phase_name(query_phase phase);
+
+/*
+Accumulates wall-clock time and hardware counter deltas for each phase of
+the query pipeline, across however many rows are evaluated. Phases must not
+overlap, and each end must match the phase of the last begin. Without
+permission for the counters, only the times are kept.
+*/
+class PhaseProfiler
+{
+public:
+    PhaseProfiler(vector<perf_counter_type> events = ALL_PERF_COUNTERS);
+
+    ~PhaseProfiler();
+
+    void begin(query_phase phase);
+
+    void end(query_phase phase);
+
+    /* Prints the totals of each phase, divided by num_rows */
+    void print_report(size_t num_rows) const;
+
+private:
+    PerfCounters counters_;
+    bool in_phase_ = false;
+    query_phase phase_ = query_phase::multiply;
+    vector<uint64_t> phase_start_counts_;
+    chrono::high_resolution_clock::time_point phase_start_time_;
+    vector<int64_t> phase_times_;             // In nanoseconds
+    vector<vector<uint64_t>> phase_counts_;
+};
@@ -0,0 +1,432 @@
+#include "native/examples/examples.h"
+#include <cmath>
+#include <functional>
+#include <map>
+
+using namespace std;
+using namespace seal;
+
+/*
+Times each SEAL primitive used in my_utils.cpp in isolation, for several
+polynomial modulus degrees, modulus chains and ciphertext levels, for both
+CKKS and BFV.
+
+Usage: primitive_bench [--reps N] [--warmup N] [--out FILE]
+                       [--baseline FILE] [--threshold FRACTION]
+
+The results are written as CSV to --out (primitive_bench.csv by default).
+With --baseline, the medians are compared against an earlier CSV, and the
+exit code is 1 if any primitive got slower by more than --threshold.
+*/
+
+struct BenchOptions
+{
+    size_t reps = 50;
+    size_t warmup = 5;
+    string out = "primitive_bench.csv";
+    string baseline;
+    double threshold = 0.1;
+};
+
+struct BenchResult
+{
+    string scheme;
+    string primitive;
+    size_t poly_modulus_degree;
+    string coeff_modulus;
+    size_t level;
+    size_t reps;
+    double mean_us;
+    double median_us;
+    double stddev_us;
+    double min_us;
+    double max_us;
+
+    string key() const
+    {
+        return scheme + "," + primitive + "," + to_string(poly_modulus_degree) + "," + coeff_modulus + "," + to_string(level);
+    }
+};
+
+/* Runs setup untimed before every repetition, then times op */
+static BenchResult measure(
+    const string &scheme, const string &primitive, size_t poly_modulus_degree, const string &coeff_modulus, size_t level,
+    const BenchOptions &options, const function<void()> &setup, const function<void()> &op
+)
+{
+    for (size_t i = 0; i < options.warmup; i++)
+    {
+        setup();
+        op();
+    }
+
+    vector<double> times(options.reps);
+    for (size_t i = 0; i < options.reps; i++)
+    {
+        setup();
+        auto time_start = chrono::high_resolution_clock::now();
+        op();
+        auto time_end = chrono::high_resolution_clock::now();
+        times[i] = chrono::duration<double, micro>(time_end - time_start).count();
+    }
+
+    BenchResult result;
+    result.scheme = scheme;
+    result.primitive = primitive;
+    result.poly_modulus_degree = poly_modulus_degree;
+    result.coeff_modulus = coeff_modulus;
+    result.level = level;
+    result.reps = options.reps;
+    result.mean_us = accumulate(times.begin(), times.end(), 0.0) / times.size();
+    double variance = 0;
+    for (double time : times)
+    {
+        variance += (time - result.mean_us) * (time - result.mean_us);
+    }
+    result.stddev_us = times.size() > 1 ? sqrt(variance / (times.size() - 1)) : 0;
+    sort(times.begin(), times.end());
+    result.median_us = times.size() % 2 ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2;
+    result.min_us = times.front();
+    result.max_us = times.back();
+    return result;
+}
+
+static void bench_ckks_parameter_set(
+    size_t poly_modulus_degree, vector<int> bit_sizes, const BenchOptions &options, vector<BenchResult> &results
+)
+{
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::ckks);
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, bit_sizes));
+    double scale = pow(2.0, bit_sizes[1]);
+    SEALContext context(parms);
+
+    string coeff_modulus;
+    for (size_t i = 0; i < bit_sizes.size(); i++)
+    {
+        coeff_modulus += (i ? "-" : "") + to_string(bit_sizes[i]);
+    }
+
+    /* Setting up keys and object instances, with only the rotation the benchmark uses */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(vector<int>{ 1 }, galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+    CKKSEncoder encoder(context);
+
+    uniform_real_distribution<double> unif(0, 1);
+    mt19937 gen(0);
+    vector<double> values(encoder.slot_count());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = unif(gen);
+    }
+
+    /*
+    Walk down the modulus chain. The lowest level has nothing left to rescale
+    to, and products are skipped wherever their scale does not fit in the
+    remaining modulus, which SEAL rejects as out of bounds.
+    */
+    for (auto context_data = context.first_context_data(); context_data; context_data = context_data->next_context_data())
+    {
+        parms_id_type parms_id = context_data->parms_id();
+        size_t level = context_data->chain_index();
+        bool product_fits = static_cast<int>(log2(scale * scale)) < context_data->total_coeff_modulus_bit_count();
+        bool can_rescale = product_fits && context_data->next_context_data() != nullptr;
+        cout << "CKKS degree " << poly_modulus_degree << ", modulus " << coeff_modulus << ", level " << level << endl;
+
+        Plaintext plain;
+        vector<double> decoded;
+        encoder.encode(values, parms_id, scale, plain);
+        Ciphertext encrypted1, encrypted2, product, destination;
+        encryptor.encrypt(plain, encrypted1);
+        encryptor.encrypt(plain, encrypted2);
+        auto no_setup = []() {};
+
+        results.push_back(measure("ckks", "encode", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            encoder.encode(values, parms_id, scale, plain);
+        }));
+        results.push_back(measure("ckks", "decode", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            encoder.decode(plain, decoded);
+        }));
+        results.push_back(measure("ckks", "encrypt", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            encryptor.encrypt(plain, destination);
+        }));
+        results.push_back(measure("ckks", "decrypt", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            decryptor.decrypt(encrypted1, plain);
+        }));
+        results.push_back(measure("ckks", "add_inplace", poly_modulus_degree, coeff_modulus, level, options,
+            [&]() { destination = encrypted1; }, [&]() { evaluator.add_inplace(destination, encrypted2); }));
+        if (product_fits)
+        {
+            results.push_back(measure("ckks", "multiply", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+                evaluator.multiply(encrypted1, encrypted2, product);
+            }));
+            results.push_back(measure("ckks", "multiply_plain", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+                evaluator.multiply_plain(encrypted1, plain, destination);
+            }));
+            results.push_back(measure("ckks", "relinearize_inplace", poly_modulus_degree, coeff_modulus, level, options,
+                [&]() { evaluator.multiply(encrypted1, encrypted2, product); },
+                [&]() { evaluator.relinearize_inplace(product, relin_keys); }));
+        }
+        if (can_rescale)
+        {
+            results.push_back(measure("ckks", "rescale_to_next_inplace", poly_modulus_degree, coeff_modulus, level, options,
+                [&]() {
+                    evaluator.multiply(encrypted1, encrypted2, product);
+                    evaluator.relinearize_inplace(product, relin_keys);
+                },
+                [&]() { evaluator.rescale_to_next_inplace(product); }));
+        }
+        results.push_back(measure("ckks", "rotate_vector", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            evaluator.rotate_vector(encrypted1, 1, galois_keys, destination);
+        }));
+    }
+}
+
+/* BFV has no rescale, so a ciphertext only changes level through mod switching */
+static void bench_bfv_parameter_set(size_t poly_modulus_degree, const BenchOptions &options, vector<BenchResult> &results)
+{
+    /* Setting parameters */
+    EncryptionParameters parms(scheme_type::bfv);
+    parms.set_poly_modulus_degree(poly_modulus_degree);
+    parms.set_coeff_modulus(CoeffModulus::BFVDefault(poly_modulus_degree));
+    parms.set_plain_modulus(PlainModulus::Batching(poly_modulus_degree, 20));
+    SEALContext context(parms);
+
+    string coeff_modulus;
+    for (size_t i = 0; i < parms.coeff_modulus().size(); i++)
+    {
+        coeff_modulus += (i ? "-" : "") + to_string(parms.coeff_modulus()[i].bit_count());
+    }
+
+    /* Setting up keys and object instances, with only the rotation the benchmark uses */
+    KeyGenerator keygen(context);
+    SecretKey secret_key = keygen.secret_key();
+    PublicKey public_key;
+    keygen.create_public_key(public_key);
+    RelinKeys relin_keys;
+    keygen.create_relin_keys(relin_keys);
+    GaloisKeys galois_keys;
+    keygen.create_galois_keys(vector<int>{ 1 }, galois_keys);
+    Encryptor encryptor(context, public_key);
+    Evaluator evaluator(context);
+    Decryptor decryptor(context, secret_key);
+    BatchEncoder encoder(context);
+
+    uniform_int_distribution<uint64_t> unif(0, parms.plain_modulus().value() - 1);
+    mt19937 gen(0);
+    vector<uint64_t> values(encoder.slot_count());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        values[i] = unif(gen);
+    }
+
+    /* Plaintexts are not tied to a level, so encoding, decoding and encryption are only timed at the first */
+    Plaintext plain;
+    vector<uint64_t> decoded;
+    encoder.encode(values, plain);
+    Ciphertext fresh;
+    encryptor.encrypt(plain, fresh);
+    auto no_setup = []() {};
+    size_t first_level = context.first_context_data()->chain_index();
+    results.push_back(measure("bfv", "encode", poly_modulus_degree, coeff_modulus, first_level, options, no_setup, [&]() {
+        encoder.encode(values, plain);
+    }));
+    results.push_back(measure("bfv", "decode", poly_modulus_degree, coeff_modulus, first_level, options, no_setup, [&]() {
+        encoder.decode(plain, decoded);
+    }));
+    results.push_back(measure("bfv", "encrypt", poly_modulus_degree, coeff_modulus, first_level, options, no_setup, [&]() {
+        encryptor.encrypt(plain, fresh);
+    }));
+
+    for (auto context_data = context.first_context_data(); context_data; context_data = context_data->next_context_data())
+    {
+        parms_id_type parms_id = context_data->parms_id();
+        size_t level = context_data->chain_index();
+        bool can_mod_switch = context_data->next_context_data() != nullptr;
+        cout << "BFV degree " << poly_modulus_degree << ", modulus " << coeff_modulus << ", level " << level << endl;
+
+        Ciphertext encrypted1, encrypted2, product, destination;
+        encryptor.encrypt(plain, encrypted1);
+        encryptor.encrypt(plain, encrypted2);
+        evaluator.mod_switch_to_inplace(encrypted1, parms_id);
+        evaluator.mod_switch_to_inplace(encrypted2, parms_id);
+
+        results.push_back(measure("bfv", "decrypt", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            decryptor.decrypt(encrypted1, plain);
+        }));
+        results.push_back(measure("bfv", "add_inplace", poly_modulus_degree, coeff_modulus, level, options,
+            [&]() { destination = encrypted1; }, [&]() { evaluator.add_inplace(destination, encrypted2); }));
+        results.push_back(measure("bfv", "multiply", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            evaluator.multiply(encrypted1, encrypted2, product);
+        }));
+        results.push_back(measure("bfv", "multiply_plain", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            evaluator.multiply_plain(encrypted1, plain, destination);
+        }));
+        results.push_back(measure("bfv", "relinearize_inplace", poly_modulus_degree, coeff_modulus, level, options,
+            [&]() { evaluator.multiply(encrypted1, encrypted2, product); },
+            [&]() { evaluator.relinearize_inplace(product, relin_keys); }));
+        if (can_mod_switch)
+        {
+            results.push_back(measure("bfv", "mod_switch_to_next_inplace", poly_modulus_degree, coeff_modulus, level, options,
+                [&]() { destination = encrypted1; }, [&]() { evaluator.mod_switch_to_next_inplace(destination); }));
+        }
+        results.push_back(measure("bfv", "rotate_rows", poly_modulus_degree, coeff_modulus, level, options, no_setup, [&]() {
+            evaluator.rotate_rows(encrypted1, 1, galois_keys, destination);
+        }));
+    }
+}
+
+static void write_results(const string &path, vector<BenchResult> &results)
+{
+    ofstream out(path);
+    if (!out)
+    {
+        throw runtime_error("could not open " + path);
+    }
+    out << "scheme,primitive,poly_modulus_degree,coeff_modulus,level,reps,mean_us,median_us,stddev_us,min_us,max_us" << endl;
+    for (BenchResult &result : results)
+    {
+        out << result.key() << "," << result.reps << "," << result.mean_us << "," << result.median_us << ","
+            << result.stddev_us << "," << result.min_us << "," << result.max_us << endl;
+    }
+}
+
+/* Reads the median of every key from an earlier CSV */
+static map<string, double> read_baseline(const string &path)
+{
+    ifstream in(path);
+    if (!in)
+    {
+        throw runtime_error("could not open " + path);
+    }
+    map<string, double> medians;
+    string line;
+    getline(in, line);
+    while (getline(in, line))
+    {
+        vector<string> fields;
+        stringstream line_stream(line);
+        string field;
+        while (getline(line_stream, field, ','))
+        {
+            fields.push_back(field);
+        }
+        if (fields.size() < 8)
+        {
+            continue;
+        }
+        medians[fields[0] + "," + fields[1] + "," + fields[2] + "," + fields[3] + "," + fields[4]] = stod(fields[7]);
+    }
+    return medians;
+}
+
+static bool compare_with_baseline(vector<BenchResult> &results, const BenchOptions &options)
+{
+    map<string, double> baseline = read_baseline(options.baseline);
+    bool regressed = false;
+    cout << endl << "Comparison of medians with " << options.baseline << ":" << endl;
+    for (BenchResult &result : results)
+    {
+        auto it = baseline.find(result.key());
+        if (it == baseline.end() || it->second <= 0)
+        {
+            continue;
+        }
+        double change = result.median_us / it->second - 1;
+        bool is_regression = change > options.threshold;
+        regressed = regressed || is_regression;
+        cout << (is_regression ? "  REGRESSION " : "             ") << setw(56) << left << result.key() << right
+             << setw(12) << fixed << setprecision(2) << it->second << " -> " << setw(12) << result.median_us << " us ("
+             << showpos << change * 100 << noshowpos << "%)" << endl;
+    }
+    return regressed;
+}
+
+int main(int argc, char *argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            cerr << "Missing value for " << arg << endl;
+            return 2;
+        }
+        if (arg == "--reps")
+        {
+            options.reps = max<size_t>(1, stoul(argv[++i]));
+        }
+        else if (arg == "--warmup")
+        {
+            options.warmup = stoul(argv[++i]);
+        }
+        else if (arg == "--out")
+        {
+            options.out = argv[++i];
+        }
+        else if (arg == "--baseline")
+        {
+            options.baseline = argv[++i];
+        }
+        else if (arg == "--threshold")
+        {
+            options.threshold = stod(argv[++i]);
+        }
+        else
+        {
+            cerr << "Unknown option " << arg << endl;
+            return 2;
+        }
+    }
+
+    /* Parameter sets: the one used by the tests, and shorter and longer chains around it */
+    vector<pair<size_t, vector<int>>> parameter_sets = {
+        { 4096, { 40, 20, 40 } },
+        { 4096, { 30, 24, 24, 30 } },
+        { 8192, { 60, 40, 40, 60 } },
+        { 8192, { 40, 30, 30, 30, 30, 40 } },
+        { 16384, { 60, 40, 40, 60 } },
+        { 16384, { 60, 40, 40, 40, 40, 40, 40, 60 } }
+    };
+
+    vector<BenchResult> results;
+    for (auto &parameter_set : parameter_sets)
+    {
+        bench_ckks_parameter_set(parameter_set.first, parameter_set.second, options, results);
+    }
+
+    /* BFV with the default modulus chains, as used by the integer tests */
+    for (size_t poly_modulus_degree : { 4096, 8192, 16384 })
+    {
+        bench_bfv_parameter_set(poly_modulus_degree, options, results);
+    }
+
+    cout << endl << setw(8) << left << "scheme" << setw(28) << "primitive" << setw(8) << "degree" << setw(26) << "coeff_modulus" << setw(7) << "level"
+         << right << setw(14) << "median (us)" << setw(14) << "stddev (us)" << endl;
+    for (BenchResult &result : results)
+    {
+        cout << setw(8) << left << result.scheme << setw(28) << result.primitive << setw(8) << result.poly_modulus_degree << setw(26) << result.coeff_modulus
+             << setw(7) << result.level << right << setw(14) << fixed << setprecision(2) << result.median_us << setw(14)
+             << result.stddev_us << endl;
+    }
+
+    write_results(options.out, results);
+    cout << endl << "Results written to " << options.out << endl;
+
+    if (!options.baseline.empty() && compare_with_baseline(results, options))
+    {
+        return 1;
+    }
+    return 0;
+}
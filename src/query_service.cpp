@@ -0,0 +1,275 @@
+#include "native/examples/examples.h"
+#include "query_service.h"
+#include "ipc_utils.h"
+#include "my_utils.h"
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace seal;
+
+static const size_t WIRE_HEADER_SIZE = 8;
+
+static string wire_header(wire_message_type type)
+{
+    string header(WIRE_HEADER_SIZE, '\0');
+    memcpy(&header[0], &WIRE_MAGIC, sizeof(WIRE_MAGIC));
+    header[4] = static_cast<char>(WIRE_VERSION);
+    header[5] = static_cast<char>(type);
+    return header;
+}
+
+static void check_wire_header(const string &message, wire_message_type type)
+{
+    uint32_t magic;
+    if (message.size() < WIRE_HEADER_SIZE)
+    {
+        throw runtime_error("wire message is truncated");
+    }
+    memcpy(&magic, message.data(), sizeof(magic));
+    if (magic != WIRE_MAGIC || static_cast<uint8_t>(message[4]) != WIRE_VERSION)
+    {
+        throw runtime_error("wire message has an unknown magic or version");
+    }
+    if (static_cast<wire_message_type>(message[5]) != type)
+    {
+        throw runtime_error("wire message has the wrong type");
+    }
+}
+
+string encode_query(const Serializable<Ciphertext> &query, compr_mode_type compr_mode)
+{
+    stringstream stream;
+    uint64_t count = 1;
+    stream.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    query.save(stream, compr_mode);
+    return wire_header(wire_message_type::query) + stream.str();
+}
+
+Ciphertext decode_query(SEALContext &context, const string &message)
+{
+    check_wire_header(message, wire_message_type::query);
+    vector<Ciphertext> query = deserialize_ciphertexts(context, message.substr(WIRE_HEADER_SIZE), 1);
+    if (query.size() != 1)
+    {
+        throw runtime_error("query message must hold exactly one ciphertext");
+    }
+    return query[0];
+}
+
+string encode_results(vector<Ciphertext> &vector_of_encrypted, compr_mode_type compr_mode)
+{
+    return wire_header(wire_message_type::result) + serialize_ciphertexts(vector_of_encrypted, compr_mode);
+}
+
+vector<Ciphertext> decode_results(SEALContext &context, const string &message)
+{
+    check_wire_header(message, wire_message_type::result);
+    return deserialize_ciphertexts(context, message.substr(WIRE_HEADER_SIZE));
+}
+
+compr_mode_type best_compr_mode()
+{
+    if (Serialization::IsSupportedComprMode(compr_mode_type::zstd))
+    {
+        return compr_mode_type::zstd;
+    }
+    if (Serialization::IsSupportedComprMode(compr_mode_type::zlib))
+    {
+        return compr_mode_type::zlib;
+    }
+    return compr_mode_type::none;
+}
+
+QueryServer::QueryServer(
+    SEALContext &context, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    vector<Ciphertext> &encrypted_matrix, size_t dimension, compr_mode_type result_compr_mode
+)
+    : context_(context), evaluator_(context), relin_keys_(relin_keys), galois_keys_(galois_keys),
+      encrypted_matrix_(encrypted_matrix), dimension_(dimension), result_compr_mode_(result_compr_mode),
+      max_query_bytes_(WIRE_HEADER_SIZE + sizeof(uint64_t) + max_ciphertext_bytes(context))
+{
+    check_dimension(context, dimension);
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0)
+    {
+        throw runtime_error(string("socket failed: ") + strerror(errno));
+    }
+
+    /* Listen on an ephemeral loopback port */
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t addr_len = sizeof(addr);
+    if (bind(listen_fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 || listen(listen_fd_, SOMAXCONN) < 0 ||
+        getsockname(listen_fd_, reinterpret_cast<sockaddr *>(&addr), &addr_len) < 0)
+    {
+        int error = errno;
+        close(listen_fd_);
+        throw runtime_error(string("could not listen on loopback: ") + strerror(error));
+    }
+    port_ = ntohs(addr.sin_port);
+
+    accept_thread_ = thread(&QueryServer::accept_loop, this);
+}
+
+QueryServer::~QueryServer()
+{
+    stop();
+}
+
+uint16_t QueryServer::port() const
+{
+    return port_;
+}
+
+void QueryServer::stop()
+{
+    if (stopping_.exchange(true))
+    {
+        return;
+    }
+
+    /* Shutting down the sockets unblocks accept and recv */
+    shutdown(listen_fd_, SHUT_RDWR);
+    accept_thread_.join();
+    close(listen_fd_);
+
+    /* The threads are joined outside the lock, since each takes it once more on its way out */
+    map<int, thread> connections;
+    {
+        lock_guard<mutex> lock(connections_mutex_);
+        for (auto &connection : connections_)
+        {
+            shutdown(connection.first, SHUT_RDWR);
+        }
+        connections.swap(connections_);
+        finished_fds_.clear();
+    }
+    for (auto &connection : connections)
+    {
+        connection.second.join();
+        close(connection.first);
+    }
+}
+
+void QueryServer::reap_finished_connections()
+{
+    vector<thread> finished_threads;
+    vector<int> finished_fds;
+    {
+        lock_guard<mutex> lock(connections_mutex_);
+        for (int fd : finished_fds_)
+        {
+            finished_threads.push_back(move(connections_[fd]));
+            connections_.erase(fd);
+        }
+        finished_fds.swap(finished_fds_);
+    }
+    for (size_t i = 0; i < finished_fds.size(); i++)
+    {
+        finished_threads[i].join();
+        close(finished_fds[i]);
+    }
+}
+
+void QueryServer::accept_loop()
+{
+    while (!stopping_)
+    {
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        int flag = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+        /* A finished connection keeps its socket open until it is reaped, so fd cannot collide with it */
+        reap_finished_connections();
+        lock_guard<mutex> lock(connections_mutex_);
+        connections_[fd] = thread(&QueryServer::serve_connection, this, fd);
+    }
+}
+
+void QueryServer::serve_connection(int fd)
+{
+    try
+    {
+        string message;
+        while (recv_message(fd, message, max_query_bytes_))
+        {
+            Ciphertext encrypted_vector = decode_query(context_, message);
+            vector<Ciphertext> product_vector = CKKS_matrix_vector_product(
+                evaluator_, relin_keys_, galois_keys_, encrypted_matrix_, encrypted_vector, dimension_
+            );
+
+            /* Only the last prime is needed to decrypt */
+            for (size_t i = 0; i < product_vector.size(); i++)
+            {
+                evaluator_.mod_switch_to_inplace(product_vector[i], context_.last_parms_id());
+            }
+            send_message(fd, encode_results(product_vector, result_compr_mode_));
+        }
+    }
+    catch (const exception &e)
+    {
+        if (!stopping_)
+        {
+            cerr << "Query connection failed: " << e.what() << endl;
+        }
+    }
+
+    /* The accept loop joins this thread and closes the socket the next time it runs */
+    lock_guard<mutex> lock(connections_mutex_);
+    finished_fds_.push_back(fd);
+}
+
+QueryClient::QueryClient(SEALContext &context, uint16_t port) : context_(context)
+{
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0)
+    {
+        throw runtime_error(string("socket failed: ") + strerror(errno));
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+    {
+        int error = errno;
+        close(fd_);
+        throw runtime_error(string("connect failed: ") + strerror(error));
+    }
+    int flag = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+QueryClient::~QueryClient()
+{
+    close(fd_);
+}
+
+vector<Ciphertext> QueryClient::query(const string &encoded_query, size_t &bytes_received)
+{
+    send_message(fd_, encoded_query);
+    string message;
+    if (!recv_message(fd_, message))
+    {
+        throw runtime_error("server closed the connection");
+    }
+    bytes_received = message.size();
+    return decode_results(context_, message);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <atomic>
+#include <map>
+
+using namespace std;
+using namespace seal;
+
+/*
+Wire format of the query service. Every message is a fixed header followed
+by the ciphertexts as written by serialize_ciphertexts. SEAL records the
+compression mode in each ciphertext header, so the reader does not need to
+be told which one was used.
+*/
+enum class wire_message_type : uint8_t
+{
+    query = 1,
+    result = 2
+};
+
+const uint32_t WIRE_MAGIC = 0x50444548;  // "HEDP"
+const uint8_t WIRE_VERSION = 1;
+
+/*
+Encodes a query. Queries encrypted with encrypt_symmetric are serialized
+with a seed in place of half of the ciphertext, which roughly halves their
+size on the wire.
+*/
+string encode_query(const Serializable<Ciphertext> &query, compr_mode_type compr_mode);
+
+Ciphertext decode_query(SEALContext &context, const string &message);
+
+string encode_results(vector<Ciphertext> &vector_of_encrypted, compr_mode_type compr_mode);
+
+vector<Ciphertext> decode_results(SEALContext &context, const string &message);
+
+/* Returns the best compression mode SEAL was built with */
+compr_mode_type best_compr_mode();
+
+/*
+Serves packed matrix vector products over loopback TCP. Each connection is
+handled on its own thread. Results are mod-switched to the last level before
+they are sent, which drops all but one prime and shrinks them accordingly.
+A query larger than one ciphertext at the first level closes its connection.
+*/
+class QueryServer
+{
+public:
+    QueryServer(
+        SEALContext &context, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+        vector<Ciphertext> &encrypted_matrix, size_t dimension, compr_mode_type result_compr_mode
+    );
+
+    ~QueryServer();
+
+    uint16_t port() const;
+
+    void stop();
+
+private:
+    void accept_loop();
+
+    void serve_connection(int fd);
+
+    /* Joins the threads of connections that have ended and closes their sockets */
+    void reap_finished_connections();
+
+    SEALContext &context_;
+    Evaluator evaluator_;
+    RelinKeys &relin_keys_;
+    GaloisKeys &galois_keys_;
+    vector<Ciphertext> &encrypted_matrix_;
+    size_t dimension_;
+    compr_mode_type result_compr_mode_;
+    uint64_t max_query_bytes_;
+
+    int listen_fd_ = -1;
+    uint16_t port_ = 0;
+    atomic<bool> stopping_{ false };
+    thread accept_thread_;
+    mutex connections_mutex_;
+    map<int, thread> connections_;
+    vector<int> finished_fds_;
+};
+
+/* A blocking client for one connection to a QueryServer */
+class QueryClient
+{
+public:
+    QueryClient(SEALContext &context, uint16_t port);
+
+    ~QueryClient();
+
+    /* Sends an encoded query and returns the decoded results */
+    vector<Ciphertext> query(const string &encoded_query, size_t &bytes_received);
+
+private:
+    SEALContext &context_;
+    int fd_ = -1;
+};
@@ -0,0 +1,89 @@
+#include "native/examples/examples.h"
+#include "result_stream.h"
+
+using namespace std;
+using namespace seal;
+
+void ResultChannel::push(ResultChunk chunk)
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        chunks_.push_back(move(chunk));
+    }
+    changed_.notify_one();
+}
+
+void ResultChannel::close()
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        closed_ = true;
+    }
+    changed_.notify_all();
+}
+
+bool ResultChannel::pop(ResultChunk &chunk)
+{
+    unique_lock<mutex> lock(mutex_);
+    changed_.wait(lock, [&]() { return closed_ || !chunks_.empty(); });
+    if (chunks_.empty())
+    {
+        return false;
+    }
+    chunk = move(chunks_.front());
+    chunks_.pop_front();
+    return true;
+}
+
+RunningTopK::RunningTopK(size_t k) : k_(k)
+{}
+
+void RunningTopK::merge(const vector<double> &scores, size_t first_index)
+{
+    for (size_t i = 0; i < scores.size(); i++)
+    {
+        if (heap_.size() < k_)
+        {
+            heap_.emplace(scores[i], first_index + i);
+        }
+        else if (k_ > 0 && scores[i] > heap_.top().first)
+        {
+            heap_.pop();
+            heap_.emplace(scores[i], first_index + i);
+        }
+    }
+}
+
+vector<pair<double, size_t>> RunningTopK::top() const
+{
+    auto heap = heap_;
+    vector<pair<double, size_t>> best;
+    while (!heap.empty())
+    {
+        best.push_back(heap.top());
+        heap.pop();
+    }
+    reverse(best.begin(), best.end());
+    return best;
+}
+
+void streaming_CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    vector<Ciphertext> &encrypted_matrix, const PreparedQuery &query, size_t dimension,
+    size_t chunk_size, const function<void(ResultChunk &)> &on_chunk
+)
+{
+    chunk_size = max<size_t>(chunk_size, 1);
+    DotProductEngine<CKKSScheme> engine(evaluator, relin_keys, galois_keys, dimension);
+    for (size_t first_row = 0; first_row < encrypted_matrix.size(); first_row += chunk_size)
+    {
+        ResultChunk chunk;
+        chunk.first_row = first_row;
+        size_t end = min(first_row + chunk_size, encrypted_matrix.size());
+        for (size_t i = first_row; i < end; i++)
+        {
+            chunk.products.push_back(CKKS_dot_product(engine, encrypted_matrix[i], query));
+        }
+        on_chunk(chunk);
+    }
+}
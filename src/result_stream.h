@@ -0,0 +1,64 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include "my_utils.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <queue>
+
+using namespace std;
+using namespace seal;
+
+/* Result ciphertexts of consecutive rows, starting at first_row */
+struct ResultChunk
+{
+    size_t first_row = 0;
+    vector<Ciphertext> products;
+};
+
+/* Hands chunks from the evaluating thread to the client as they are produced */
+class ResultChannel
+{
+public:
+    void push(ResultChunk chunk);
+
+    /* No more chunks will be pushed */
+    void close();
+
+    /* Waits for the next chunk, returning false once the channel is closed and empty */
+    bool pop(ResultChunk &chunk);
+
+private:
+    mutex mutex_;
+    condition_variable changed_;
+    deque<ResultChunk> chunks_;
+    bool closed_ = false;
+};
+
+/* The k best scores merged so far, with the indices of their embeddings */
+class RunningTopK
+{
+public:
+    RunningTopK(size_t k);
+
+    void merge(const vector<double> &scores, size_t first_index);
+
+    /* Best first */
+    vector<pair<double, size_t>> top() const;
+
+private:
+    size_t k_;
+    priority_queue<pair<double, size_t>, vector<pair<double, size_t>>, greater<pair<double, size_t>>> heap_;
+};
+
+/*
+Evaluates the rows in order, chunk_size at a time, and passes each chunk to
+on_chunk as soon as its products are ready, so that the client can decrypt
+the first results while the rest of the rows are still being evaluated.
+*/
+void streaming_CKKS_matrix_vector_product(
+    Evaluator &evaluator, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    vector<Ciphertext> &encrypted_matrix, const PreparedQuery &query, size_t dimension,
+    size_t chunk_size, const function<void(ResultChunk &)> &on_chunk
+);
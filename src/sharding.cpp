@@ -0,0 +1,316 @@
+#include "native/examples/examples.h"
+#include "sharding.h"
+#include "ipc_utils.h"
+#include "my_utils.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace seal;
+
+/* Every worker reply starts with one of these */
+enum class shard_reply_type : uint32_t
+{
+    results = 1,
+    error = 2
+};
+
+/*
+Serves queries over rows [begin, end) until the coordinator closes the
+socket. A query that fails is answered with an error reply carrying the
+message, and the worker keeps serving.
+*/
+static void run_worker(
+    SEALContext &context, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    vector<Ciphertext> &encrypted_matrix, size_t begin, size_t end, size_t dimension, int fd
+)
+{
+    Evaluator evaluator(context);
+    DotProductEngine<CKKSScheme> engine(context, evaluator, relin_keys, galois_keys, dimension);
+    chrono::high_resolution_clock::time_point time_start, time_mid, time_end;
+
+    /* An oversized query throws out of here, and the worker exits and closes its socket */
+    uint64_t max_query_bytes = sizeof(uint64_t) + max_ciphertext_bytes(context);
+    string message;
+    while (recv_message(fd, message, max_query_bytes))
+    {
+        string reply;
+        try
+        {
+            vector<Ciphertext> query = deserialize_ciphertexts(context, message, 1);
+            if (query.size() != 1)
+            {
+                throw invalid_argument("query must be one ciphertext");
+            }
+
+            time_start = chrono::high_resolution_clock::now();
+            vector<Ciphertext> product_vector(end - begin);
+            for (size_t i = begin; i < end; i++)
+            {
+                engine.dot_product(encrypted_matrix[i], query[0], product_vector[i - begin]);
+            }
+            time_mid = chrono::high_resolution_clock::now();
+            string results = serialize_ciphertexts(product_vector);
+            time_end = chrono::high_resolution_clock::now();
+
+            /* The results follow the compute and serialization times of the worker */
+            shard_reply_type type = shard_reply_type::results;
+            int64_t timings[2] = {
+                chrono::duration_cast<chrono::microseconds>(time_mid - time_start).count(),
+                chrono::duration_cast<chrono::microseconds>(time_end - time_mid).count()
+            };
+            reply = string(reinterpret_cast<const char *>(&type), sizeof(type))
+                    + string(reinterpret_cast<const char *>(timings), sizeof(timings)) + results;
+        }
+        catch (const exception &e)
+        {
+            shard_reply_type type = shard_reply_type::error;
+            reply = string(reinterpret_cast<const char *>(&type), sizeof(type)) + e.what();
+        }
+        send_message(fd, reply);
+    }
+}
+
+/* Kills and reaps the workers started so far if the coordinator fails to start */
+class WorkerGuard
+{
+public:
+    WorkerGuard(vector<int> &sockets, vector<pid_t> &workers) : sockets_(sockets), workers_(workers)
+    {}
+
+    ~WorkerGuard()
+    {
+        if (dismissed_)
+        {
+            return;
+        }
+        for (int fd : sockets_)
+        {
+            close(fd);
+        }
+        for (pid_t pid : workers_)
+        {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        sockets_.clear();
+        workers_.clear();
+    }
+
+    void dismiss()
+    {
+        dismissed_ = true;
+    }
+
+private:
+    vector<int> &sockets_;
+    vector<pid_t> &workers_;
+    bool dismissed_ = false;
+};
+
+ShardCoordinator::ShardCoordinator(
+    SEALContext &context, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+    vector<Ciphertext> &encrypted_matrix, size_t dimension, size_t num_workers
+)
+    : context_(context)
+{
+    if (num_workers == 0)
+    {
+        throw invalid_argument("num_workers must be at least 1");
+    }
+    check_dimension(context, dimension);
+
+    /* Avoid duplicating buffered output in the children */
+    cout.flush();
+    cerr.flush();
+
+    WorkerGuard guard(sockets_, workers_);
+    sockets_.reserve(num_workers);
+    workers_.reserve(num_workers);
+    size_t num_rows = encrypted_matrix.size();
+    for (size_t w = 0; w < num_workers; w++)
+    {
+        size_t begin = num_rows * w / num_workers;
+        size_t end = num_rows * (w + 1) / num_workers;
+
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+        {
+            throw runtime_error(string("socketpair failed: ") + strerror(errno));
+        }
+
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            close(fds[0]);
+            close(fds[1]);
+            throw runtime_error(string("fork failed: ") + strerror(errno));
+        }
+        if (pid == 0)
+        {
+            /* The worker only keeps its own end of its own socket */
+            close(fds[0]);
+            for (int fd : sockets_)
+            {
+                close(fd);
+            }
+            int status = 0;
+            try
+            {
+                run_worker(context, relin_keys, galois_keys, encrypted_matrix, begin, end, dimension, fds[1]);
+            }
+            catch (const exception &e)
+            {
+                cerr << "Worker " << w << " failed: " << e.what() << endl;
+                status = 1;
+            }
+            close(fds[1]);
+            _exit(status);
+        }
+
+        close(fds[1]);
+        sockets_.push_back(fds[0]);
+        workers_.push_back(pid);
+        shard_sizes_.push_back(end - begin);
+    }
+    guard.dismiss();
+}
+
+ShardCoordinator::~ShardCoordinator()
+{
+    for (int fd : sockets_)
+    {
+        close(fd);
+    }
+    for (pid_t pid : workers_)
+    {
+        waitpid(pid, nullptr, 0);
+    }
+}
+
+vector<Ciphertext> ShardCoordinator::matrix_vector_product(Ciphertext &encrypted_vector)
+{
+    chrono::high_resolution_clock::time_point time_start, time_end;
+    ShardTimings timings;
+    auto total_start = chrono::high_resolution_clock::now();
+
+    /* Scatter the serialized query */
+    time_start = chrono::high_resolution_clock::now();
+    vector<Ciphertext> query = { encrypted_vector };
+    string message = serialize_ciphertexts(query);
+    time_end = chrono::high_resolution_clock::now();
+    timings.serialize_query = chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+    timings.query_bytes = message.size();
+
+    for (int fd : sockets_)
+    {
+        send_message(fd, message);
+    }
+
+    /* Gather the shards in row order */
+    vector<Ciphertext> product_vector;
+
+    /*
+    Every reply is read even after one fails, so that no stale reply is left
+    on a socket for the next query, and then the first error is thrown
+    */
+    string error;
+    auto fail = [&](const string &what) {
+        if (error.empty())
+        {
+            error = what;
+        }
+    };
+    for (size_t w = 0; w < sockets_.size(); w++)
+    {
+        /* The rest of an oversized reply is left unread, so the socket cannot be used again */
+        size_t max_reply_bytes = sizeof(shard_reply_type) + 2 * sizeof(int64_t) + sizeof(uint64_t)
+                                 + shard_sizes_[w] * max_ciphertext_bytes(context_);
+        try
+        {
+            if (!recv_message(sockets_[w], message, max_reply_bytes))
+            {
+                fail("worker " + to_string(w) + " closed its socket");
+                continue;
+            }
+        }
+        catch (const exception &e)
+        {
+            shutdown(sockets_[w], SHUT_RDWR);
+            fail("worker " + to_string(w) + " sent an unreadable reply: " + e.what());
+            continue;
+        }
+
+        /* Check the reply type and size before parsing anything out of it */
+        shard_reply_type type;
+        int64_t worker_timings[2];
+        size_t header_bytes = sizeof(type) + sizeof(worker_timings);
+        if (message.size() < sizeof(type))
+        {
+            fail("worker " + to_string(w) + " sent a truncated reply");
+            continue;
+        }
+        memcpy(&type, message.data(), sizeof(type));
+        if (type == shard_reply_type::error)
+        {
+            fail("worker " + to_string(w) + " failed: " + message.substr(sizeof(type)));
+            continue;
+        }
+        if (type != shard_reply_type::results || message.size() < header_bytes)
+        {
+            fail("worker " + to_string(w) + " sent a malformed reply");
+            continue;
+        }
+        memcpy(worker_timings, message.data() + sizeof(type), sizeof(worker_timings));
+        timings.max_worker_compute = max(timings.max_worker_compute, worker_timings[0]);
+        timings.max_worker_serialize = max(timings.max_worker_serialize, worker_timings[1]);
+        timings.result_bytes += message.size() - header_bytes;
+
+        time_start = chrono::high_resolution_clock::now();
+        vector<Ciphertext> shard_products;
+        try
+        {
+            shard_products = deserialize_ciphertexts(context_, message.substr(header_bytes), shard_sizes_[w]);
+        }
+        catch (const exception &e)
+        {
+            fail("worker " + to_string(w) + " sent unreadable results: " + e.what());
+            continue;
+        }
+        time_end = chrono::high_resolution_clock::now();
+        timings.deserialize_results += chrono::duration_cast<chrono::microseconds>(time_end - time_start).count();
+        if (shard_products.size() != shard_sizes_[w])
+        {
+            fail("worker " + to_string(w) + " returned the wrong number of results");
+            continue;
+        }
+
+        for (size_t i = 0; i < shard_products.size(); i++)
+        {
+            product_vector.push_back(move(shard_products[i]));
+        }
+    }
+    if (!error.empty())
+    {
+        throw runtime_error(error);
+    }
+
+    auto total_end = chrono::high_resolution_clock::now();
+    timings.total = chrono::duration_cast<chrono::microseconds>(total_end - total_start).count();
+    last_timings_ = timings;
+    return product_vector;
+}
+
+ShardTimings ShardCoordinator::last_timings() const
+{
+    return last_timings_;
+}
+
+size_t ShardCoordinator::num_workers() const
+{
+    return workers_.size();
+}
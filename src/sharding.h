@@ -0,0 +1,53 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <sys/types.h>
+
+using namespace std;
+using namespace seal;
+
+/* Timings of the last scatter/gather query, in microseconds */
+struct ShardTimings
+{
+    int64_t total = 0;
+    int64_t serialize_query = 0;
+    int64_t deserialize_results = 0;
+    int64_t max_worker_compute = 0;
+    int64_t max_worker_serialize = 0;
+    size_t query_bytes = 0;
+    size_t result_bytes = 0;
+};
+
+/*
+Partitions the packed encrypted rows into contiguous shards across local
+worker processes. Each worker is forked with its own shard of rows and the
+evaluation keys, and is connected to the coordinator by a UNIX-domain socket
+pair. A query is serialized once, scattered to every worker, and the
+per-shard result ciphertexts are gathered back in row order, so the results
+have the same shape as CKKS_matrix_vector_product and can be passed to
+packed_CKKS_results.
+*/
+class ShardCoordinator
+{
+public:
+    ShardCoordinator(
+        SEALContext &context, RelinKeys &relin_keys, GaloisKeys &galois_keys,
+        vector<Ciphertext> &encrypted_matrix, size_t dimension, size_t num_workers
+    );
+
+    /* Closes the sockets and waits for the workers to exit */
+    ~ShardCoordinator();
+
+    vector<Ciphertext> matrix_vector_product(Ciphertext &encrypted_vector);
+
+    ShardTimings last_timings() const;
+
+    size_t num_workers() const;
+
+private:
+    SEALContext &context_;
+    vector<int> sockets_;
+    vector<pid_t> workers_;
+    vector<size_t> shard_sizes_;
+    ShardTimings last_timings_;
+};
@@ -0,0 +1,119 @@
+#include "native/examples/examples.h"
+#include "sparse_index.h"
+#include "my_utils.h"
+
+using namespace std;
+using namespace seal;
+
+vector<EncryptedQueryTerm> encrypt_sparse_query(
+    CKKSEncoder &encoder, Encryptor &encryptor, const SparseVector &query, double scale
+)
+{
+    vector<EncryptedQueryTerm> terms(query.indices.size());
+    Plaintext plain_value;
+    for (size_t i = 0; i < query.indices.size(); i++)
+    {
+        terms[i].dimension = query.indices[i];
+        encoder.encode(query.values[i], scale, plain_value);
+        encryptor.encrypt(plain_value, terms[i].encrypted);
+    }
+    return terms;
+}
+
+SparsePostingIndex::SparsePostingIndex(
+    SEALContext &context, PublicKey &public_key, double scale, size_t num_dimensions,
+    vector<SparseVector> &documents, size_t num_threads
+)
+    : postings_(num_dimensions)
+{
+    size_t slot_count = CKKSEncoder(context).slot_count();
+    num_groups_ = (documents.size() + slot_count - 1) / slot_count;
+
+    /* Gathering the non-zero postings, then encrypting them all at once */
+    map<pair<size_t, size_t>, size_t> posting_rows;   // (dimension, group) to its row in the matrix
+    vector<vector<double>> matrix;
+    for (size_t doc = 0; doc < documents.size(); doc++)
+    {
+        size_t group = doc / slot_count;
+        for (size_t i = 0; i < documents[doc].indices.size(); i++)
+        {
+            auto key = make_pair(static_cast<size_t>(documents[doc].indices[i]), group);
+            auto it = posting_rows.find(key);
+            if (it == posting_rows.end())
+            {
+                it = posting_rows.emplace(key, matrix.size()).first;
+                matrix.emplace_back(slot_count, 0ULL);
+            }
+            matrix[it->second][doc % slot_count] = documents[doc].values[i];
+        }
+    }
+
+    vector<Ciphertext> encrypted_matrix(matrix.size());
+    CKKS_encrypt_rows(context, public_key, scale, matrix, encrypted_matrix, num_threads);
+    for (auto &posting_row : posting_rows)
+    {
+        postings_[posting_row.first.first].emplace(posting_row.first.second, move(encrypted_matrix[posting_row.second]));
+    }
+}
+
+vector<Ciphertext> SparsePostingIndex::scores(
+    Evaluator &evaluator, RelinKeys &relin_keys, const vector<EncryptedQueryTerm> &query, vector<size_t> &group_ids
+)
+{
+    vector<Ciphertext> score_vector;
+    group_ids.clear();
+    Ciphertext product;
+    for (size_t group = 0; group < num_groups_; group++)
+    {
+        Ciphertext accumulated;
+        bool is_empty = true;
+        for (const EncryptedQueryTerm &term : query)
+        {
+            if (term.dimension >= postings_.size())
+            {
+                continue;
+            }
+            auto posting = postings_[term.dimension].find(group);
+            if (posting == postings_[term.dimension].end())
+            {
+                continue;
+            }
+
+            /* Relinearization is deferred until every product has been added */
+            if (is_empty)
+            {
+                evaluator.multiply(posting->second, term.encrypted, accumulated);
+                is_empty = false;
+            }
+            else
+            {
+                evaluator.multiply(posting->second, term.encrypted, product);
+                evaluator.add_inplace(accumulated, product);
+            }
+        }
+        if (is_empty)
+        {
+            continue;
+        }
+        evaluator.relinearize_inplace(accumulated, relin_keys);
+        evaluator.rescale_to_next_inplace(accumulated);
+        score_vector.push_back(move(accumulated));
+        group_ids.push_back(group);
+    }
+    return score_vector;
+}
+
+size_t SparsePostingIndex::num_groups() const
+{
+    return num_groups_;
+}
+
+size_t SparsePostingIndex::num_postings() const
+{
+    size_t count = 0;
+    for (auto &dimension_postings : postings_)
+    {
+        count += dimension_postings.size();
+    }
+    return count;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "native/examples/examples.h"
+#include <map>
+
+using namespace std;
+using namespace seal;
+
+/* A sparse embedding, as the dimensions of its non-zero values and the values */
+struct SparseVector
+{
+    vector<uint32_t> indices;
+    vector<double> values;
+};
+
+/* One encrypted value of a sparse query, duplicated across every slot */
+struct EncryptedQueryTerm
+{
+    uint32_t dimension;
+    Ciphertext encrypted;
+};
+
+/*
+The query side of the sparse path. Only the non-zero values of the query are
+encrypted and sent, which reveals which dimensions are non-zero but not their
+values.
+*/
+vector<EncryptedQueryTerm> encrypt_sparse_query(
+    CKKSEncoder &encoder, Encryptor &encryptor, const SparseVector &query, double scale
+);
+
+/*
+Stores sparse embeddings in a transposed, per-dimension posting layout.
+The documents are split into groups of slot_count, document i taking slot
+i % slot_count of group i / slot_count. For every dimension and group with
+at least one non-zero value, a posting ciphertext holds the values of that
+dimension for the documents of the group, and all-zero postings are not
+stored at all.
+
+The scores of a group are the sum, over the non-zero dimensions of the
+query, of each posting times the encrypted query value, so the work is
+proportional to the number of non-zero query dimensions and needs no
+rotations. The products are accumulated unrelinearized and relinearized and
+rescaled once per group.
+*/
+class SparsePostingIndex
+{
+public:
+    SparsePostingIndex(
+        SEALContext &context, PublicKey &public_key, double scale, size_t num_dimensions,
+        vector<SparseVector> &documents, size_t num_threads = 0
+    );
+
+    /*
+    Returns one ciphertext per group with at least one posting in the query
+    dimensions, whose slot j holds the score of document
+    group_ids[k] * slot_count + j.
+    */
+    vector<Ciphertext> scores(
+        Evaluator &evaluator, RelinKeys &relin_keys, const vector<EncryptedQueryTerm> &query, vector<size_t> &group_ids
+    );
+
+    size_t num_groups() const;
+
+    size_t num_postings() const;
+
+private:
+    size_t num_groups_ = 0;
+    vector<map<size_t, Ciphertext>> postings_;   // Per dimension, by group
+};
@@ -16,6 +16,22 @@ int main()
         cout << "| 3. Float Matrix Vector       | 3_float_matrix_vector.cpp    |" << endl;
         cout << "| 4. Packed Matrix Vector      | 4_packed_matrix_vector.cpp   |" << endl;
         cout << "| 5. Timed Packed Products     | 5_timed_packed_products.cpp  |" << endl;
+        cout << "| 6. Incremental Index         | 6_incremental_index.cpp      |" << endl;
+        cout << "| 7. Sharded Products          | 7_sharded_products.cpp       |" << endl;
+        cout << "| 8. Query Service             | 8_query_service.cpp          |" << endl;
+        cout << "| 9. Batched Scheduler         | 9_batched_scheduler.cpp      |" << endl;
+        cout << "| 10. Prepared Query           | 10_prepared_query.cpp        |" << endl;
+        cout << "| 11. Parallel Ingest          | 11_parallel_ingest.cpp       |" << endl;
+        cout << "| 12. Arena Scan               | 12_arena_scan.cpp            |" << endl;
+        cout << "| 13. Filtered Search          | 13_filtered_search.cpp       |" << endl;
+        cout << "| 14. Cascaded Search          | 14_cascaded_search.cpp       |" << endl;
+        cout << "| 15. Prefetched Scan          | 15_prefetched_scan.cpp       |" << endl;
+        cout << "| 16. Capacity Planner         | 16_capacity_planner.cpp      |" << endl;
+        cout << "| 17. Streaming Results        | 17_streaming_results.cpp     |" << endl;
+        cout << "| 18. Sparse Embeddings        | 18_sparse_embeddings.cpp     |" << endl;
+        cout << "| 19. Batched Decryption       | 19_batched_decryption.cpp    |" << endl;
+        cout << "| 20. CKKS Dot Product Engine  | 20_dot_product_engine.cpp    |" << endl;
+        cout << "| 21. BFV Dot Product Engine   | 21_bfv_product_engine.cpp    |" << endl;
         cout << "+------------------------------+------------------------------+" << endl;
 
         /*
@@ -32,12 +48,12 @@ int main()
         bool valid = true;
         do
         {
-            cout << endl << "> Run test (1 ~ 5) or exit (0): ";
+            cout << endl << "> Run test (1 ~ 21) or exit (0): ";
             if (!(cin >> selection))
             {
                 valid = false;
             }
-            else if (selection < 0 || selection > 5)
+            else if (selection < 0 || selection > 21)
             {
                 valid = false;
             }
@@ -47,7 +63,7 @@ int main()
             }
             if (!valid)
             {
-                cout << "  [Beep~~] valid option: type 0 ~ 5" << endl;
+                cout << "  [Beep~~] valid option: type 0 ~ 21" << endl;
                 cin.clear();
                 cin.ignore(numeric_limits<streamsize>::max(), '\n');
             }
@@ -75,6 +91,70 @@ int main()
             test_timed_packed_products();
             break;
 
+        case 6:
+            test_incremental_index();
+            break;
+
+        case 7:
+            test_sharded_products();
+            break;
+
+        case 8:
+            test_query_service();
+            break;
+
+        case 9:
+            test_batched_scheduler();
+            break;
+
+        case 10:
+            test_prepared_query();
+            break;
+
+        case 11:
+            test_parallel_ingest();
+            break;
+
+        case 12:
+            test_arena_scan();
+            break;
+
+        case 13:
+            test_filtered_search();
+            break;
+
+        case 14:
+            test_cascaded_search();
+            break;
+
+        case 15:
+            test_prefetched_scan();
+            break;
+
+        case 16:
+            test_capacity_planner();
+            break;
+
+        case 17:
+            test_streaming_results();
+            break;
+
+        case 18:
+            test_sparse_embeddings();
+            break;
+
+        case 19:
+            test_batched_decryption();
+            break;
+
+        case 20:
+            test_dot_product_engine();
+            break;
+
+        case 21:
+            test_bfv_dot_product_engine();
+            break;
+
         case 0:
             return 0;
         }
@@ -11,4 +11,36 @@ void test_float_matrix_vector_product();
 
 void test_packed_matrix_vector_product();
 
-void test_timed_packed_products();
\ No newline at end of file
+void test_timed_packed_products();
+
+void test_incremental_index();
+
+void test_sharded_products();
+
+void test_query_service();
+
+void test_batched_scheduler();
+
+void test_prepared_query();
+
+void test_parallel_ingest();
+
+void test_arena_scan();
+
+void test_filtered_search();
+
+void test_cascaded_search();
+
+void test_prefetched_scan();
+
+void test_capacity_planner();
+
+void test_streaming_results();
+
+void test_sparse_embeddings();
+
+void test_batched_decryption();
+
+void test_dot_product_engine();
+
+void test_bfv_dot_product_engine();
\ No newline at end of file